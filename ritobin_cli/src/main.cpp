@@ -1,9 +1,13 @@
 #include <cstdlib>
 #include <argparse.hpp>
 #include <ritobin/bin_io.hpp>
+#include <ritobin/bin_mmap.hpp>
 #include <ritobin/bin_unhash.hpp>
 #include <optional>
 #include <filesystem>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #ifdef WIN32
 #include <fcntl.h>
@@ -19,7 +23,11 @@ static void set_binary_mode(FILE*) {}
 
 using ritobin::Bin;
 using ritobin::BinUnhasher;
+using ritobin::FNV1a;
+using ritobin::io::BinCompat;
+using ritobin::io::BinFilter;
 using ritobin::io::DynamicFormat;
+using ritobin::io::MappedFile;
 namespace fs = std::filesystem;
 
 static DynamicFormat const* get_format(std::string const& name, std::string_view data, std::string const& file_name) {
@@ -38,10 +46,40 @@ static DynamicFormat const* get_format(std::string const& name, std::string_view
     }
 }
 
+static std::vector<std::string> split(std::string const& list, char separator) {
+    std::vector<std::string> result;
+    for (size_t start = 0, end = 0; start < list.size(); start = end + 1) {
+        end = std::min(list.find(separator, start), list.size());
+        if (end != start) {
+            result.push_back(list.substr(start, end - start));
+        }
+    }
+    return result;
+}
+
+static FNV1a parse_hash(std::string const& name) {
+    if (name.starts_with("0x")) {
+        return FNV1a { static_cast<uint32_t>(std::stoul(name, nullptr, 16)) };
+    }
+    return FNV1a { name };
+}
+
+static std::vector<FNV1a> parse_hashes(std::string const& list, char separator) {
+    std::vector<FNV1a> result;
+    for (auto const& name: split(list, separator)) {
+        result.push_back(parse_hash(name));
+    }
+    return result;
+}
+
 struct Args {
     bool keep_hashed = {};
     bool recursive = {};
     bool log = {};
+    bool verify = {};
+    size_t jobs = 1;
+    bool filtered = {};
+    BinFilter filter = {};
 
     std::string dir = {};
     std::string input_file = {};
@@ -66,6 +104,10 @@ struct Args {
                 .help("log more")
                 .default_value(false)
                 .implicit_value(true);
+        program.add_argument("--verify")
+                .help("only check that input can be read, nothing is written")
+                .default_value(false)
+                .implicit_value(true);
         program.add_argument("input")
                 .help("input file or directory")
                 .required();
@@ -78,6 +120,18 @@ struct Args {
         program.add_argument("-o", "--output-format")
                 .default_value(std::string(""))
                 .help("format of output file");
+        program.add_argument("-j", "--jobs")
+                .default_value(std::string("1"))
+                .help("number of threads to use, 0 for all cores");
+        program.add_argument("--entry")
+                .default_value(std::string(""))
+                .help("comma separated entries to read from .bin, names or 0x hashes");
+        program.add_argument("--class")
+                .default_value(std::string(""))
+                .help("comma separated entry classes to read from .bin, names or 0x hashes");
+        program.add_argument("--field")
+                .default_value(std::string(""))
+                .help("comma separated fields to read from .bin, nested fields are separated with .");
         program.add_argument("-d", "--dir-hashes")
                 .default_value((fs::path(argv[0]).parent_path() / "hashes").generic_string())
                 .help("directory containing hashes");
@@ -87,6 +141,14 @@ struct Args {
             keep_hashed = program.get<bool>("--keep-hashed");
             recursive = program.get<bool>("--recursive");
             log = program.get<bool>("--verbose");
+            verify = program.get<bool>("--verify");
+            jobs = std::stoul(program.get<std::string>("--jobs"));
+            filter.entries = parse_hashes(program.get<std::string>("--entry"), ',');
+            filter.classes = parse_hashes(program.get<std::string>("--class"), ',');
+            for (auto const& path: split(program.get<std::string>("--field"), ',')) {
+                filter.fields.push_back(parse_hashes(path, '.'));
+            }
+            filtered = !filter.entries.empty() || !filter.classes.empty() || !filter.fields.empty();
             input_format = program.get<std::string>("--input-format");
             output_format = program.get<std::string>("--output-format");
             if (recursive) {
@@ -96,7 +158,7 @@ struct Args {
                 input_file = program.get<std::string>("input");
                 output_file = program.get<std::string>("output");
             }
-        } catch (const std::runtime_error& err) {
+        } catch (const std::exception& err) {
             std::cerr << err.what() << std::endl;
             std::cerr << program << std::endl;
             std::cerr << "Formats:" << std::endl;
@@ -108,6 +170,28 @@ struct Args {
         unhasher = std::make_shared<std::optional<BinUnhasher>>(std::nullopt);
     }
 
+    static void create_parent_dir(std::string const& name) {
+        auto parent_dir = fs::path(name).parent_path();
+        if (!parent_dir.empty()) {
+            if (std::error_code ec = {}; (fs::create_directories(parent_dir, ec)), ec != std::error_code{}) {
+                throw std::runtime_error("Failed to create parent directory: " + ec.message());
+            }
+        }
+    }
+
+    // Output is written next to target first and only moved over it once complete,
+    // failed write never leaves partial or truncated file behind
+    static void replace_file(std::string const& temp_file, std::string const& name, std::string error) {
+        std::error_code ec = {};
+        if (error.empty() && (fs::rename(temp_file, name, ec), ec != std::error_code{})) {
+            error = "Failed to replace file: " + ec.message();
+        }
+        if (!error.empty()) {
+            fs::remove(temp_file, ec);
+            throw std::runtime_error(error);
+        }
+    }
+
     template<char M>
     FILE* open_file(std::string const& name) {
         char mode[] = { M, 'b', '\0'};
@@ -119,12 +203,7 @@ struct Args {
             set_binary_mode(file);
         } else {
             if constexpr (M == 'w') {
-                auto parent_dir = fs::path(name).parent_path();
-                if (!parent_dir.empty()) {
-                    if (std::error_code ec = {}; (fs::create_directories(parent_dir, ec)), ec != std::error_code{}) {
-                        throw std::runtime_error("Failed to create parent directory: " + ec.message());
-                    }
-                }
+                create_parent_dir(name);
             }
             file = fopen(name.c_str(), mode);
         }
@@ -137,21 +216,34 @@ struct Args {
     void read(Bin& bin) {
         auto file = open_file<'r'>(input_file);
 
-        std::vector<char> data;
-        char buffer[4096];
+        // pipes can be decoded while they are still being written when format is known upfront
+        if (auto compat = BinCompat::get(input_format); compat && input_file == "-" && !filtered) {
+            auto error = read_stream(file, compat, bin);
+            fclose(file);
+            if (!error.empty()) {
+                throw std::runtime_error(error);
+            }
+            if (output_file.empty() && output_format.empty()) {
+                output_format = DynamicFormat::get(input_format)->oposite_name();
+            }
+            return;
+        }
+
+        MappedFile data;
         if (log) {
             std::cerr << "Reading..." << std::endl;
         }
-        while (auto read = fread(buffer, 1, sizeof(buffer), file)) {
-            data.insert(data.end(), buffer, buffer + read);
-        }
+        auto error = data.open(file);
         fclose(file);
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
 
         if (log) {
             std::cerr << "Parsing..." << std::endl;
         }
-        auto format = get_format(input_format, std::string_view{data.data(), data.size()}, input_file);
-        auto error = format->read(bin, data);
+        auto format = get_format(input_format, std::string_view{data.span().data(), data.span().size()}, input_file);
+        error = read_format(format, bin, data.span());
         if (!error.empty()) {
             throw std::runtime_error(error);
         }
@@ -160,35 +252,81 @@ struct Args {
         }
     }
 
-    void unhash(Bin& bin) {
-        if (!keep_hashed) {
-            if (!*unhasher) {
-                if (log) {
-                    std::cerr << "Loading hashes..." << std::endl;
-                }
-                auto& uh = unhasher->emplace();
-                if (dir.empty()) {
-                    dir = ".";
-                }
-                uh.load_fnv1a_CDTB(dir + "/hashes.binentries.txt");
-                uh.load_fnv1a_CDTB(dir + "/hashes.binhashes.txt");
-                uh.load_fnv1a_CDTB(dir + "/hashes.bintypes.txt");
-                uh.load_fnv1a_CDTB(dir + "/hashes.binfields.txt");
-                uh.load_xxh64_CDTB(dir + "/hashes.game.txt");
-                uh.load_xxh64_CDTB(dir + "/hashes.lcu.txt");
+    std::string read_stream(FILE* file, BinCompat const* compat, Bin& bin) {
+        if (log) {
+            std::cerr << "Reading and parsing..." << std::endl;
+        }
+        auto entries = ritobin::Map { ritobin::Type::HASH, ritobin::Type::EMBED, {} };
+        auto stream = ritobin::io::BinStreamReader(compat, [&entries](ritobin::Hash& key, ritobin::Embed& value) {
+            entries.items.emplace_back(ritobin::Pair { std::move(key), std::move(value) });
+            return true;
+        });
+        std::vector<char> chunk(64 * 1024);
+        while (auto size = fread(chunk.data(), 1, chunk.size(), file)) {
+            if (auto error = stream.feed({ chunk.data(), size }); !error.empty()) {
+                return error;
             }
+        }
+        if (ferror(file)) {
+            return "Failed to read file!";
+        }
+        if (auto error = stream.finish(); !error.empty()) {
+            return error;
+        }
+        bin = std::move(stream.header);
+        bin.sections["entries"] = std::move(entries);
+        return {};
+    }
+
+    std::string read_format(DynamicFormat const* format, Bin& bin, std::span<char const> data) {
+        if (filtered) {
+            if (auto compat = BinCompat::get(format->name())) {
+                return ritobin::io::read_binary(bin, data, compat, filter);
+            }
+        }
+        if (jobs != 1) {
+            if (auto compat = BinCompat::get(format->name())) {
+                return ritobin::io::read_binary(bin, data, compat, jobs);
+            }
+            if (format->name() == "text") {
+                return ritobin::io::read_text(bin, data, jobs);
+            }
+        }
+        return format->read(bin, data);
+    }
+
+    BinUnhasher const* load_unhasher() {
+        if (keep_hashed) {
+            return nullptr;
+        }
+        if (!*unhasher) {
             if (log) {
-                std::cerr << "Unashing..." << std::endl;
+                std::cerr << "Loading hashes..." << std::endl;
+            }
+            auto& uh = unhasher->emplace();
+            if (dir.empty()) {
+                dir = ".";
             }
-            (*unhasher)->unhash_bin(bin);
+            uh.load_fnv1a_CDTB(dir + "/hashes.binentries.txt");
+            uh.load_fnv1a_CDTB(dir + "/hashes.binhashes.txt");
+            uh.load_fnv1a_CDTB(dir + "/hashes.bintypes.txt");
+            uh.load_fnv1a_CDTB(dir + "/hashes.binfields.txt");
+            uh.load_xxh64_CDTB(dir + "/hashes.game.txt");
+            uh.load_xxh64_CDTB(dir + "/hashes.lcu.txt");
         }
+        return &**unhasher;
     }
 
-    void write(Bin& bin) {
-        auto format = get_format(output_format, "", output_file);
-        if (!keep_hashed && !format->output_allways_hashed()) {
-            unhash(bin);
+    void unhash(Bin& bin) {
+        if (auto uh = load_unhasher()) {
+            if (log) {
+                std::cerr << "Unashing..." << std::endl;
+            }
+            uh->unhash_bin(bin);
         }
+    }
+
+    void default_output_file(DynamicFormat const* format) {
         if (output_file.empty()) {
             if (input_file == "-") {
                 output_file = "-";
@@ -199,6 +337,18 @@ struct Args {
                 }
             }
         }
+    }
+
+    void write(Bin& bin) {
+        auto format = get_format(output_format, "", output_file);
+        if (!keep_hashed && !format->output_allways_hashed()) {
+            unhash(bin);
+        }
+        default_output_file(format);
+
+        if (auto compat = BinCompat::get(format->name())) {
+            return write_bin(bin, compat);
+        }
 
         if (log) {
             std::cerr << "Serializing..." << std::endl;
@@ -218,8 +368,224 @@ struct Args {
         fclose(file);
     }
 
+    std::string verify_file(std::string const& name) {
+        auto file = open_file<'r'>(name);
+        MappedFile data;
+        auto error = data.open(file);
+        fclose(file);
+        if (!error.empty()) {
+            return error;
+        }
+        auto format = get_format(input_format, std::string_view{data.span().data(), data.span().size()}, name);
+        if (auto compat = BinCompat::get(format->name())) {
+            return ritobin::io::verify_binary(data.span(), compat);
+        }
+        auto bin = Bin{};
+        return format->read(bin, data.span());
+    }
+
+    size_t verify_files(std::vector<std::string> const& files) {
+        auto threads = jobs != 0 ? jobs : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, files.size());
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> failed = 0;
+        std::mutex log_mutex;
+        auto worker = [&] {
+            for (size_t i = next++; i < files.size(); i = next++) {
+                std::string error;
+                try {
+                    error = verify_file(files[i]);
+                } catch (const std::runtime_error& err) {
+                    error = err.what();
+                }
+                std::lock_guard lock(log_mutex);
+                if (!error.empty()) {
+                    ++failed;
+                    std::cerr << "In: " << files[i] << std::endl;
+                    std::cerr << "Error: " << error << std::endl;
+                } else if (log) {
+                    std::cerr << "OK: " << files[i] << std::endl;
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < threads; i++) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread: pool) {
+            thread.join();
+        }
+        return failed;
+    }
+
+    // .bin is serialized straight into output instead of through another full copy in memory
+    void write_bin(Bin const& bin, BinCompat const* compat) {
+        if (output_file == "-") {
+            auto file = open_file<'w'>(output_file);
+            if (log) {
+                std::cerr << "Serializing and writing data..." << std::endl;
+            }
+            auto error = ritobin::io::write_binary(bin, file, compat, jobs);
+            fclose(file);
+            if (!error.empty()) {
+                throw std::runtime_error(error);
+            }
+            return;
+        }
+
+        size_t size = 0;
+        auto error = ritobin::io::size_binary(bin, size);
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+        auto const temp_file = output_file + ".tmp";
+        if (log) {
+            std::cerr << "Open file for mapping: " << temp_file << std::endl;
+        }
+        create_parent_dir(output_file);
+        MappedFile file;
+        error = file.create(temp_file, size);
+        if (error.empty()) {
+            if (log) {
+                std::cerr << "Serializing..." << std::endl;
+            }
+            error = ritobin::io::write_binary(bin, file.writable_span(), compat, jobs);
+        }
+        if (error.empty()) {
+            error = file.flush();
+        }
+        file.close();
+        replace_file(temp_file, output_file, error);
+    }
+
+    // bin to bin conversion only differs in type bytes so nothing needs to be decoded
+    void transcode(BinCompat const* from, BinCompat const* to) {
+        auto file = open_file<'r'>(input_file);
+        MappedFile data;
+        if (log) {
+            std::cerr << "Reading..." << std::endl;
+        }
+        auto error = data.open(file);
+        fclose(file);
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+
+        if (log) {
+            std::cerr << "Transcoding..." << std::endl;
+        }
+        std::vector<char> out;
+        error = ritobin::io::transcode_binary(out, data.span(), from, to);
+        // output can be same file as input
+        data.close();
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+
+        default_output_file(DynamicFormat::get(output_format));
+        file = open_file<'w'>(output_file);
+        if (log) {
+            std::cerr << "Writing data..." << std::endl;
+        }
+        fwrite(out.data(), 1, out.size(), file);
+        fflush(file);
+        fclose(file);
+    }
+
+    // text and json are written while .bin is walked so Bin is never built
+    void transcode_text(BinCompat const* from, DynamicFormat const* format) {
+        auto file = open_file<'r'>(input_file);
+        MappedFile data;
+        if (log) {
+            std::cerr << "Reading..." << std::endl;
+        }
+        auto error = data.open(file);
+        fclose(file);
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+
+        auto uh = format->output_allways_hashed() ? nullptr : load_unhasher();
+        default_output_file(format);
+        // input stays mapped while output is written so it goes to temporary file that replaces output once done
+        auto const temp_file = output_file == "-" ? output_file : output_file + ".tmp";
+        file = open_file<'w'>(temp_file);
+        if (log) {
+            std::cerr << "Transcoding and writing data..." << std::endl;
+        }
+        if (format->name() == "json") {
+            error = ritobin::io::write_json(data.span(), from, uh, file, 2);
+        } else {
+            error = ritobin::io::write_text(data.span(), from, uh, file, 4);
+        }
+        fclose(file);
+        data.close();
+        if (temp_file == "-") {
+            if (!error.empty()) {
+                throw std::runtime_error(error);
+            }
+            return;
+        }
+        replace_file(temp_file, output_file, error);
+    }
+
+    // text is compiled into .bin as it is read so Bin is never built
+    void assemble(BinCompat const* to) {
+        auto file = open_file<'r'>(input_file);
+        MappedFile data;
+        if (log) {
+            std::cerr << "Reading..." << std::endl;
+        }
+        auto error = data.open(file);
+        fclose(file);
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+
+        if (log) {
+            std::cerr << "Assembling..." << std::endl;
+        }
+        std::vector<char> out;
+        error = ritobin::io::assemble_binary(out, data.span(), to);
+        // output can be same file as input
+        data.close();
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+
+        default_output_file(DynamicFormat::get(to->name()));
+        file = open_file<'w'>(output_file);
+        if (log) {
+            std::cerr << "Writing data..." << std::endl;
+        }
+        fwrite(out.data(), 1, out.size(), file);
+        fflush(file);
+        fclose(file);
+    }
+
     void run_once() {
         try {
+            if (auto from = BinCompat::get(input_format), to = BinCompat::get(output_format); from && to && !filtered) {
+                return transcode(from, to);
+            }
+            if (auto from = BinCompat::get(input_format); from && !filtered) {
+                if (output_file.empty() && output_format.empty()) {
+                    output_format = DynamicFormat::get(input_format)->oposite_name();
+                }
+                if (auto to = get_format(output_format, "", output_file); to->name() == "text" || to->name() == "json") {
+                    return transcode_text(from, to);
+                }
+            }
+            // with more jobs entries are parsed on multiple threads into Bin instead
+            if (input_format == "text" && !filtered && jobs == 1) {
+                if (output_file.empty() && output_format.empty()) {
+                    output_format = DynamicFormat::get(input_format)->oposite_name();
+                }
+                if (auto to = BinCompat::get(get_format(output_format, "", output_file)->name())) {
+                    return assemble(to);
+                }
+            }
             auto bin = Bin{};
             read(bin);
             write(bin);
@@ -230,9 +596,13 @@ struct Args {
         }
     }
 
-    void run() {
+    int run() {
         if (!recursive) {
-            return run_once();
+            if (verify) {
+                return verify_files({ input_file }) == 0 ? 0 : 1;
+            }
+            run_once();
+            return 0;
         }
 
         if (!fs::exists(input_dir) || !fs::is_directory(input_dir)) {
@@ -253,6 +623,7 @@ struct Args {
             throw std::runtime_error("Format must have default extension!");
         }
 
+        std::vector<std::string> files;
         for (auto const& entry: fs::recursive_directory_iterator(input_dir)) {
             if (!entry.is_regular_file()) {
                 continue;
@@ -261,9 +632,18 @@ struct Args {
             if (path.extension() != extension) {
                 continue;
             }
-            this->input_file = path.generic_string();
+            files.push_back(path.generic_string());
+        }
+
+        if (verify) {
+            return verify_files(files) == 0 ? 0 : 1;
+        }
+
+        for (auto const& file: files) {
+            this->input_file = file;
             Args {*this}.run_once();
         }
+        return 0;
     }
 };
 
@@ -272,8 +652,7 @@ struct Args {
 int main(int argc, char** argv) {
     try {
         auto args = Args(argc, argv);
-        args.run();
-        return 0;
+        return args.run();
     } catch (const std::runtime_error& err) {
         std::cerr << err.what() << std::endl;
         return -1;
@@ -1,12 +1,14 @@
 #include <cstdlib>
 #include <portable-file-dialogs.h>
 #include <ritobin/bin_io.hpp>
+#include <ritobin/bin_mmap.hpp>
 #include <ritobin/bin_unhash.hpp>
 #include <optional>
 
 using ritobin::Bin;
 using ritobin::BinUnhasher;
 using ritobin::io::DynamicFormat;
+using ritobin::io::MappedFile;
 
 struct App {
     std::string dir;
@@ -16,6 +18,7 @@ struct App {
     std::string output_filename = {};
     DynamicFormat const* input_format = {};
     DynamicFormat const* output_format = {};
+    MappedFile input = {};
     std::vector<char> data = {};
 
     void set_dir_from_apppath(std::string const& app) {
@@ -37,20 +40,9 @@ struct App {
     }
 
     bool read_file() {
-        data.clear();
         printf("Reading file: %s\n", input_filename.c_str());
-        auto file = fopen(input_filename.c_str(), "rb");
-        if (!file) {
-            return false;
-        }
-        auto start = ftell(file);
-        fseek(file, 0, SEEK_END);
-        auto end = ftell(file);
-        fseek(file, start, SEEK_SET);
-        data.resize((size_t)(end - start));
-        fread(data.data(), 1, data.size(), file);
-        fclose(file);
-        return true;
+        error = input.open(input_filename);
+        return error.empty();
     }
 
     bool write_file() {
@@ -117,12 +109,12 @@ struct App {
             fprintf(stderr, "Failed to read file!\n");
             return false;
         }
-        input_format = DynamicFormat::guess(data, input_filename);
+        input_format = DynamicFormat::guess(input.span(), input_filename);
         if (!input_format) {
             fprintf(stderr, "Input file has unknown format!\n");
             return false;
         }
-        error = input_format->read(bin, data);
+        error = input_format->read(bin, input.span());
         if (!error.empty()) {
             fprintf(stderr, "Failed to process file:%s\n", error.c_str());
             return false;
@@ -131,6 +123,7 @@ struct App {
             fprintf(stderr, "No output file selected!\n");
             return false;
         }
+        input.close();
         data.clear();
         output_format = DynamicFormat::guess(data, output_filename);
         if (!output_format) {
@@ -1,9 +1,17 @@
 #ifndef BIN_IO_HPP
 #define BIN_IO_HPP
 
+#include <cstdio>
+#include <functional>
+#include <iterator>
 #include <span>
+#include <unordered_set>
 #include "bin_types.hpp"
 
+namespace ritobin {
+    struct BinUnhasher;
+}
+
 namespace ritobin::io {
     struct BinCompat {
         virtual char const* name() const noexcept = 0;
@@ -28,15 +36,280 @@ namespace ritobin::io {
         static DynamicFormat const* guess(std::span<char const> data, std::string_view file_name) noexcept;
     };
 
+    struct BinIndex {
+        struct Entry {
+            uint32_t key = {};
+            uint32_t name = {};
+            // Entry bytes including length prefix
+            std::span<char const> data = {};
+        };
+
+        std::span<char const> data = {};
+        BinCompat const* compat = {};
+        // All sections except entries
+        Bin header = {};
+        std::vector<Entry> entries = {};
+        std::unordered_map<uint32_t, size_t> by_key = {};
+        std::unordered_map<uint32_t, std::vector<size_t>> by_name = {};
+
+        // Find entry by its key hash
+        Entry const* find(FNV1a const& key) const noexcept;
+        // Find entries by their class hash
+        std::span<size_t const> find_class(FNV1a const& name) const noexcept;
+        // Decode single entry
+        std::string read_entry(Entry const& entry, Hash& key, Embed& value) const noexcept;
+    };
+
+    // Original bytes of entries read from .bin file, lets write_binary copy unmodified entries verbatim.
+    // Entries are only known to be modified through edit and touch, any other change to an entry is silently
+    // lost because its original bytes get written instead, turn on checked while that isn't certain.
+    struct BinSource {
+        struct Entry {
+            uint32_t name = {};
+            // Entry bytes including length prefix
+            std::span<char const> data = {};
+        };
+
+        BinCompat const* compat = {};
+        std::unordered_map<uint32_t, Entry> entries = {};
+        // Keys of entries that have to be encoded again
+        std::unordered_set<uint32_t> dirty = {};
+        // Encode clean entries anyway and fail when they differ from original bytes, catches edits made without edit
+        bool checked = {};
+
+        // Entry of bin to modify, marked as dirty so it gets encoded again, nullptr when bin has no such entry
+        Embed* edit(Bin& bin, FNV1a const& key);
+
+        // Mark entry as modified, for edits that don't go through edit such as adding or replacing entries
+        void touch(FNV1a const& key) {
+            dirty.insert(key.hash());
+        }
+
+        // Original bytes of entry unless it was modified
+        Entry const* find_clean(FNV1a const& key) const noexcept;
+    };
+
+    // Edits fields of encoded .bin in place without decoding it, entries are indexed once so each edit
+    // only walks fields of its own entry, data must not be changed by anything else while patcher is used
+    struct BinPatcher {
+        // Index entries of data
+        std::string open(std::vector<char>& data, BinCompat const* compat) noexcept;
+        // Replace field value, first step of path is entry field and each one after goes into embed or pointer.
+        // When size changes bytes are spliced and every enclosing length prefix is fixed up.
+        std::string set(FNV1a const& entry, std::span<FNV1a const> path, Value const& value) noexcept;
+    private:
+        std::vector<char>* data_ = {};
+        BinCompat const* compat_ = {};
+        std::vector<size_t> offsets_ = {};
+        std::unordered_map<uint32_t, size_t> by_key_ = {};
+    };
+
+    // Selects what gets decoded when reading .bin files, empty list selects everything
+    struct BinFilter {
+        // Entry key hashes, also applies to patches
+        std::vector<FNV1a> entries = {};
+        // Entry class hashes
+        std::vector<FNV1a> classes = {};
+        // Field paths starting from entry, each step past first goes into embed or pointer
+        std::vector<std::vector<FNV1a>> fields = {};
+    };
+
+    // Where items of map sections such as entries were in .txt file from last read, lets edited text be read again
+    // parsing only items the edit touched, value read from text must not be changed by anything else in between
+    struct TextSource {
+        // Item bytes from start of its key to end of its value
+        struct Item {
+            size_t begin = {};
+            size_t end = {};
+        };
+
+        struct Section {
+            std::string name = {};
+            // Positions of opening and closing brace of section map
+            size_t open = {};
+            size_t close = {};
+            // Same order as items of section map
+            std::vector<Item> items = {};
+        };
+
+        // Size of text that was read
+        size_t size = {};
+        std::vector<Section> sections = {};
+    };
+
+    // Bytes of old text replaced by edit, several edits can be given as one range covering all of them
+    struct TextEdit {
+        // Start of replaced bytes in old text
+        size_t offset = {};
+        // Number of old bytes replaced
+        size_t removed = {};
+        // Number of new bytes in their place
+        size_t inserted = {};
+    };
+
+    // Reads .bin files incrementally from chunks of any size, keeps at most one partial entry buffered
+    struct BinStreamReader {
+        // Receives each entry as soon as it is complete, value can be moved from, return false to stop reading
+        using EntryCallback = std::function<bool(Hash& key, Embed& value)>;
+
+        BinStreamReader(BinCompat const* compat, EntryCallback on_entry) noexcept;
+
+        // Consume next chunk of data
+        std::string feed(std::span<char const> data) noexcept;
+        // Check that all data has been consumed
+        std::string finish() const noexcept;
+
+        // All sections, entries are left empty as they are passed to callback
+        Bin header = {};
+    private:
+        enum class Stage {
+            Magic,
+            LinkedCount,
+            Linked,
+            EntryCount,
+            EntryNames,
+            Entries,
+            PatchCount,
+            Patches,
+            Done,
+        };
+        BinCompat const* compat_ = {};
+        EntryCallback on_entry_ = {};
+        Stage stage_ = Stage::Magic;
+        bool is_patch_ = {};
+        uint32_t version_ = {};
+        uint32_t left_ = {};
+        size_t offset_ = {};
+        std::vector<uint32_t> names_ = {};
+        std::vector<char> buffer_ = {};
+
+        size_t item_size(std::span<char const> data) const noexcept;
+        std::string process_item(std::span<char const> data) noexcept;
+        void next_stage() noexcept;
+    };
+
+    // Decodes entries of .bin one at a time as they are pulled, only current entry is kept in memory, data must outlive reader
+    struct BinEntryReader {
+        struct Entry {
+            Hash key = {};
+            Embed value = {};
+        };
+
+        struct iterator {
+            using iterator_category = std::input_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = Entry;
+            using pointer = Entry*;
+            using reference = Entry&;
+
+            BinEntryReader* reader_ = {};
+
+            Entry& operator*() const noexcept {
+                return reader_->entry;
+            }
+
+            Entry* operator->() const noexcept {
+                return &reader_->entry;
+            }
+
+            iterator& operator++() noexcept {
+                if (!reader_->next()) {
+                    reader_ = nullptr;
+                }
+                return *this;
+            }
+
+            void operator++(int) noexcept {
+                ++*this;
+            }
+
+            bool operator==(iterator const& other) const noexcept {
+                return reader_ == other.reader_;
+            }
+        };
+
+        // Read sections before entries
+        std::string open(std::span<char const> data, BinCompat const* compat) noexcept;
+        // Decode next entry into entry, false once all entries are read or on error
+        bool next() noexcept;
+
+        // Pulls first entry, can only be iterated once
+        iterator begin() noexcept {
+            return { next() ? this : nullptr };
+        }
+
+        iterator end() noexcept {
+            return {};
+        }
+
+        // All sections, entries are left empty, patches are read once all entries are
+        Bin header = {};
+        // Last decoded entry, can be moved from
+        Entry entry = {};
+        // Set when reading stopped because of invalid data
+        std::string error = {};
+    private:
+        std::span<char const> data_ = {};
+        BinCompat const* compat_ = {};
+        char const* cur_ = {};
+        char const* names_ = {};
+        uint32_t count_ = {};
+        uint32_t index_ = {};
+        bool is_patch_ = {};
+        bool done_ = true;
+    };
+
     // Read .bin files
     extern std::string read_binary(Bin& value, std::span<char const> data, BinCompat const* compat) noexcept;
+    // Read .bin files decoding entries on multiple threads, 0 threads uses all cores
+    extern std::string read_binary(Bin& value, std::span<char const> data, BinCompat const* compat, size_t threads) noexcept;
+    // Read .bin files decoding only selected entries and fields, everything else is skipped unchecked
+    extern std::string read_binary(Bin& value, std::span<char const> data, BinCompat const* compat, BinFilter const& filter) noexcept;
+    // Read .bin files remembering original entry bytes, data must outlive source
+    extern std::string read_binary(Bin& value, std::span<char const> data, BinCompat const* compat, BinSource& source) noexcept;
+    // Check that .bin file can be read without decoding any values
+    extern std::string verify_binary(std::span<char const> data, BinCompat const* compat) noexcept;
+    // Convert .bin file between compats by rewriting type bytes, values are never decoded
+    extern std::string transcode_binary(std::vector<char>& out, std::span<char const> data, BinCompat const* from, BinCompat const* to) noexcept;
+    // Index entries of .bin file without decoding them, data must outlive index
+    extern std::string index_binary(BinIndex& index, std::span<char const> data, BinCompat const* compat) noexcept;
     // Write .bin files
     extern std::string write_binary(Bin const& value, std::vector<char>& out, BinCompat const* compat) noexcept;
+    // Write .bin files encoding entries on multiple threads, 0 threads uses all cores
+    extern std::string write_binary(Bin const& value, std::vector<char>& out, BinCompat const* compat, size_t threads) noexcept;
+    // Write .bin files copying entries that are still clean in source instead of encoding them.
+    // Every modified entry must have gone through source edit or touch, otherwise its original bytes are written.
+    extern std::string write_binary(Bin const& value, std::vector<char>& out, BinCompat const* compat, BinSource const& source) noexcept;
+    // Write .bin files streaming them to file through bounded buffer
+    extern std::string write_binary(Bin const& value, std::FILE* file, BinCompat const* compat) noexcept;
+    // Write .bin files streaming them to file, encoding as many entries as fit buffer at once on multiple threads, 0 threads uses all cores
+    extern std::string write_binary(Bin const& value, std::FILE* file, BinCompat const* compat, size_t threads) noexcept;
+    // Write .bin files into preallocated memory that must be exactly size_binary bytes
+    extern std::string write_binary(Bin const& value, std::span<char> out, BinCompat const* compat) noexcept;
+    // Write .bin files into preallocated memory encoding entries on multiple threads, 0 threads uses all cores
+    extern std::string write_binary(Bin const& value, std::span<char> out, BinCompat const* compat, size_t threads) noexcept;
+    // Exact number of bytes write_binary produces, fails on same section errors write_binary would
+    extern std::string size_binary(Bin const& value, size_t& size) noexcept;
 
     // Read .txt file
     extern std::string read_text(Bin& value, std::span<char const> data) noexcept;
+    // Read .txt file parsing map sections such as entries on multiple threads, 0 threads uses all cores
+    extern std::string read_text(Bin& value, std::span<char const> data, size_t threads) noexcept;
+    // Read .txt file remembering where each item of map sections is
+    extern std::string read_text(Bin& value, std::span<char const> data, TextSource& source) noexcept;
+    // Update value read from text that edit turned into data, items of map section touched by edit are parsed again and
+    // spliced in while edits anywhere else read whole text again. On error value is left as is and source is reset.
+    extern std::string read_text(Bin& value, std::span<char const> data, TextSource& source, TextEdit const& edit) noexcept;
+    // Compile .txt straight into binary .bin without building Bin
+    extern std::string assemble_binary(std::vector<char>& out, std::span<char const> data, BinCompat const* compat) noexcept;
     // Write .txt
     extern std::string write_text(Bin const& value, std::vector<char>& out, size_t indent_size = 2) noexcept;
+    // Write .txt straight from binary .bin without building Bin, unhasher is optional
+    extern std::string write_text(std::span<char const> data, BinCompat const* compat, BinUnhasher const* unhasher,
+                                  std::vector<char>& out, size_t indent_size = 2) noexcept;
+    // Write .txt straight from binary .bin to file, only sections written before their turn are buffered
+    extern std::string write_text(std::span<char const> data, BinCompat const* compat, BinUnhasher const* unhasher,
+                                  std::FILE* file, size_t indent_size = 2) noexcept;
 
     // Read single value
     extern std::string read_text(Value& value, std::span<char const> data) noexcept;
@@ -60,6 +333,12 @@ namespace ritobin::io {
     extern std::string read_json(Bin& value, std::span<char const> data) noexcept;
     // Write .json files
     extern std::string write_json(Bin const& value, std::vector<char>& out, int indent_size = 2) noexcept;
+    // Write .json straight from binary .bin without building Bin, unhasher is optional
+    extern std::string write_json(std::span<char const> data, BinCompat const* compat, BinUnhasher const* unhasher,
+                                  std::vector<char>& out, int indent_size = 2) noexcept;
+    // Write .json straight from binary .bin to file through bounded buffer
+    extern std::string write_json(std::span<char const> data, BinCompat const* compat, BinUnhasher const* unhasher,
+                                  std::FILE* file, int indent_size = 2) noexcept;
 
     // Wirtes lossy .json files
     extern std::string write_json_info(Bin const& value, std::vector<char>& out, int indent_size = 2) noexcept;
@@ -0,0 +1,122 @@
+#ifndef BIN_IO_BINARY_COMPAT_HPP
+#define BIN_IO_BINARY_COMPAT_HPP
+
+#include "bin_io.hpp"
+#include "bin_types_helper.hpp"
+
+namespace ritobin::io::compat_impl {
+    struct BinCompatLatestPolicy {
+        static inline constexpr char name[] = "bin";
+
+        static constexpr bool type_to_raw(Type type, uint8_t &raw) noexcept {
+            raw = static_cast<uint8_t>(type);
+            return true;
+        }
+
+        static constexpr bool raw_to_type(uint8_t raw, Type &type) noexcept {
+            type = static_cast<Type>(raw);
+            if (ValueHelper::is_primitive(type)) {
+                if (type <= ValueHelper::MAX_PRIMITIVE) {
+                    return true;
+                } else {
+                    return false;
+                }
+            } else {
+                if (type <= ValueHelper::MAX_COMPLEX) {
+                    return true;
+                } else {
+                    return false;
+                }
+            }
+        }
+    };
+
+    struct BinCompatLegacy1Policy {
+        static inline constexpr char name[] = "bin-legacy1";
+
+        static constexpr bool type_to_raw(Type type, uint8_t &raw) noexcept {
+            if (type == Type::LIST2) {
+                type = Type::LIST;
+            }
+            return BinCompatLatestPolicy::type_to_raw(type, raw);
+        }
+
+        static constexpr bool raw_to_type(uint8_t raw, Type& type) noexcept {
+            if (raw >= 18 && raw < 0x80) {
+                raw -= 18;
+                raw |= 0x80;
+            }
+            if (raw >= 0x81) {
+                raw += 1;
+            }
+            return BinCompatLatestPolicy::raw_to_type(raw, type);
+        }
+    };
+
+    // Built-in compat with its mapping precomputed into tables indexed by raw byte and by type.
+    // Class is final so readers and writers templated on it get its calls inlined instead of going through vtable.
+    template<typename Policy>
+    struct BinCompatStatic final : BinCompat {
+        struct Mapping {
+            uint8_t value = {};
+            bool valid = {};
+        };
+
+        static inline constexpr auto raw_to_type_table = [] {
+            std::array<Mapping, 256> table = {};
+            for (size_t raw = 0; raw != table.size(); raw++) {
+                Type type = {};
+                table[raw].valid = Policy::raw_to_type(static_cast<uint8_t>(raw), type);
+                table[raw].value = static_cast<uint8_t>(type);
+            }
+            return table;
+        }();
+
+        static inline constexpr auto type_to_raw_table = [] {
+            std::array<Mapping, 256> table = {};
+            for (size_t type = 0; type != table.size(); type++) {
+                uint8_t raw = {};
+                table[type].valid = Policy::type_to_raw(static_cast<Type>(type), raw);
+                table[type].value = raw;
+            }
+            return table;
+        }();
+
+        char const* name() const noexcept override {
+            return Policy::name;
+        }
+
+        bool type_to_raw(Type type, uint8_t &raw) const noexcept override {
+            auto const mapping = type_to_raw_table[static_cast<uint8_t>(type)];
+            raw = mapping.value;
+            return mapping.valid;
+        }
+
+        bool raw_to_type(uint8_t raw, Type &type) const noexcept override {
+            auto const mapping = raw_to_type_table[raw];
+            type = static_cast<Type>(mapping.value);
+            return mapping.valid;
+        }
+    };
+
+    using BinCompatLatest = BinCompatStatic<BinCompatLatestPolicy>;
+    using BinCompatLegacy1 = BinCompatStatic<BinCompatLegacy1Policy>;
+
+    extern BinCompatLatest const compat_bin_latest;
+    extern BinCompatLegacy1 const compat_bin_legacy1;
+
+    // Calls function with compat cast to its concrete type when it's built-in, so each one gets its own instantiation.
+    // Any other compat is passed through as is and goes through virtual calls.
+    template<typename F>
+    inline decltype(auto) visit_compat(BinCompat const* compat, F&& func) {
+        if (compat == &compat_bin_latest) {
+            return func(&compat_bin_latest);
+        }
+        if (compat == &compat_bin_legacy1) {
+            return func(&compat_bin_legacy1);
+        }
+        return func(compat);
+    }
+}
+
+#endif // BIN_IO_BINARY_COMPAT_HPP
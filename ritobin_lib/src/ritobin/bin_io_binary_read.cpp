@@ -1,104 +1,70 @@
-#include "bin_io.hpp"
-#include "bin_types_helper.hpp"
-
-#define bin_assert(...) do { \
-    if (auto start = reader.cur_; !(__VA_ARGS__)) { \
-        return fail_msg(#__VA_ARGS__, start); \
-    } } while(false)
+#include "bin_io_binary_read.hpp"
+#include "bin_io_binary_compat.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace ritobin::io::impl_binary_read {
-    struct BinaryReader {
-        char const* const beg_;
-        char const* cur_;
-        char const* const cap_;
-        BinCompat const* const compat_;
-
-        inline constexpr size_t position() const noexcept {
-            return cur_ - beg_;
-        }
+    // Rewrites raw type bytes in copy of walked buffer, everything else is same between compats
+    struct BinTranscodeVisitor : BinNullVisitor {
+        char const* source;
+        char* target;
+        BinCompat const* compat;
 
-        template<typename T>
-        inline bool read(T& value) noexcept {
-            static_assert(std::is_arithmetic_v<T>);
-            if (cur_ + sizeof(T) > cap_) {
+        inline bool raw_type(char const* raw, Type type) noexcept {
+            uint8_t value = {};
+            if (!compat->type_to_raw(type, value)) {
                 return false;
             }
-            memcpy(&value, cur_, sizeof(T));
-            cur_ += sizeof(T);
+            target[raw - source] = static_cast<char>(value);
             return true;
         }
+    };
 
-        template<typename T, size_t SIZE>
-        bool read(std::array<T, SIZE>& value) noexcept {
-            static_assert(std::is_arithmetic_v<T>);
-            if (cur_ + sizeof(T) * SIZE > cap_) {
-                return false;
-            }
-            memcpy(value.data(), cur_, sizeof(T) * SIZE);
-            cur_ += sizeof(T) * SIZE;
-            return true;
-        }
+    template<typename Compat>
+    struct BinBinaryReader {
+        Bin& bin;
+        BinaryReader<Compat> reader;
+        std::vector<std::pair<std::string, char const*>> error;
+        BinIndex* index = nullptr;
+        size_t threads = 1;
+        BinFilter const* filter = nullptr;
+        BinSource* source = nullptr;
 
-        template<typename T>
-        bool read(std::vector<T>& value, size_t size) noexcept {
-            static_assert(std::is_arithmetic_v<T>);
-            if (cur_ + sizeof(T) * size > cap_) {
-                return false;
-            }
-            value.resize(size);
-            memcpy(value.data(), cur_, sizeof(T) * size);
-            cur_ += sizeof(T) * size;
+        bool process() noexcept {
+            bin.sections.clear();
+            bin_assert(read_sections());
             return true;
         }
 
-        bool read(std::string& value) noexcept {
-            uint16_t size = {};
-            if (!read(size)) {
-                return false;
-            }
-            if (cur_ + size > cap_) {
-                return false;
-            }
-            value = { cur_, size };
-            cur_ += size;
+        bool process_entry(Hash& entryKeyHash, Embed& entry) noexcept {
+            bin_assert(read_entry(entryKeyHash, entry));
             return true;
         }
 
-        bool read(Type& value) noexcept {
-            uint8_t raw = {};
-            if (!read(raw)) {
-                return false;
-            }
-            return compat_->raw_to_type(raw, value);
-        }
-
-        bool read(FNV1a& value) noexcept {
-            uint32_t h;
-            if (!read(h)) {
-                return false;
-            }
-            value = FNV1a{ h };
+        bool process_patch(Hash& patchKeyHash, Embed& patch) noexcept {
+            bin_assert(read_patch(patchKeyHash, patch));
             return true;
         }
 
-        bool read(XXH64& value) noexcept {
-            uint64_t h;
-            if (!read(h)) {
-                return false;
-            }
-            value = XXH64{ h };
+        // Sections before entries, entries are then read one at a time with process_entry
+        bool process_header(bool& is_patch, uint32_t& entryCount, char const*& entryNameHashes) noexcept {
+            bin.sections.clear();
+            bin_assert(read_header(is_patch));
+            bin_assert(reader.read(entryCount));
+            entryNameHashes = reader.cur_;
+            bin_assert(reader.skip(sizeof(uint32_t) * static_cast<size_t>(entryCount)));
+            bin.sections.emplace("entries", Map{ Type::HASH, Type::EMBED, {} });
             return true;
         }
-    };
 
-    struct BinBinaryReader {
-        Bin& bin;
-        BinaryReader reader;
-        std::vector<std::pair<std::string, char const*>> error;
-
-        bool process() noexcept {
-            bin.sections.clear();
-            bin_assert(read_sections());
+        // Sections after entries
+        bool process_footer(bool is_patch) noexcept {
+            if (is_patch) {
+                bin_assert(read_patches());
+            }
+            bin_assert(reader.cur_ == reader.cap_);
             return true;
         }
 
@@ -109,10 +75,27 @@ namespace ritobin::io::impl_binary_read {
         }
 
         bool read_sections() noexcept {
+            bool is_patch = false;
+            bin_assert(read_header(is_patch));
+            if (index) {
+                bin_assert(index_entries());
+            } else if (filter) {
+                bin_assert(read_entries_filtered());
+            } else {
+                bin_assert(read_entries());
+            }
+            if (is_patch /*&& version >= 3*/) {
+                bin_assert(read_patches());
+            }
+
+            bin_assert(reader.cur_ == reader.cap_);
+            return true;
+        }
+
+        bool read_header(bool& is_patch) noexcept {
             std::array<char, 4> magic = {};
             uint32_t version = 0;
             bin_assert(reader.read(magic));
-            bool is_patch = false;
             if (magic == std::array{ 'P', 'T', 'C', 'H' }) {
                 uint64_t unk = {};
                 bin_assert(reader.read(unk));
@@ -129,12 +112,6 @@ namespace ritobin::io::impl_binary_read {
             if (version >= 2) {
                 bin_assert(read_linked());
             }
-            bin_assert(read_entries());
-            if (is_patch /*&& version >= 3*/) {
-                bin_assert(read_patches());
-            }
-
-            bin_assert(reader.cur_ == reader.cap_);
             return true;
         }
 
@@ -157,16 +134,218 @@ namespace ritobin::io::impl_binary_read {
             bin_assert(reader.read(entryCount));
             bin_assert(reader.read(entryNameHashes, entryCount));
             Map entriesMap = { Type::HASH,  Type::EMBED, {} };
+            // failing entry already carries same frames sequential decoding would add
+            if (threads > 1 && entryCount > 1 && !read_entries_parallel(entryNameHashes, entriesMap.items)) {
+                return false;
+            }
+            for (size_t i = entriesMap.items.size(); i != entryCount; i++) {
+                Hash entryKeyHash = {};
+                Embed entry = { { entryNameHashes[i] }, {} };
+                auto const start = reader.cur_;
+                bin_assert(read_entry(entryKeyHash, entry));
+                if (source) {
+                    // bytes of entries sharing key can't be told apart once looked up by it, those are always encoded again
+                    auto const key = entryKeyHash.value.hash();
+                    if (!source->entries.try_emplace(key, BinSource::Entry{ entryNameHashes[i], { start, reader.cur_ } }).second) {
+                        source->dirty.insert(key);
+                    }
+                }
+                entriesMap.items.emplace_back(Pair{ std::move(entryKeyHash), std::move(entry) });
+            }
+            bin.sections.emplace("entries", std::move(entriesMap));
+            return true;
+        }
+
+        // Decodes as many entries as can be found by scanning their length prefixes.
+        // Whatever remains is left to sequential decoding so errors are reported same as without threads.
+        bool read_entries_parallel(std::vector<uint32_t> const& entryNameHashes, PairList& items) noexcept {
+            std::vector<char const*> starts;
+            starts.reserve(entryNameHashes.size());
+            for (size_t i = 0; i != entryNameHashes.size(); i++) {
+                auto const start = reader.cur_;
+                uint32_t entryLength = 0;
+                if (!reader.read(entryLength) || !reader.skip(entryLength)) {
+                    reader.cur_ = start;
+                    break;
+                }
+                starts.push_back(start);
+            }
+            auto const end = reader.cur_;
+
+            constexpr size_t chunk = 64;
+            auto const workers = std::min(threads, (starts.size() + chunk - 1) / chunk);
+            std::atomic<size_t> next = 0;
+            std::atomic<size_t> failed = starts.size();
+            std::mutex failed_lock;
+            std::vector<std::pair<std::string, char const*>> failed_error;
+            items.resize(starts.size());
+            auto work = [&, this] {
+                for (size_t first = next.fetch_add(chunk); first < starts.size(); first = next.fetch_add(chunk)) {
+                    auto const last = std::min(first + chunk, starts.size());
+                    for (size_t i = first; i != last && i < failed; i++) {
+                        Hash entryKeyHash = {};
+                        Embed entry = { { entryNameHashes[i] }, {} };
+                        Bin unused = {};
+                        BinBinaryReader entryReader = { unused, { reader.beg_, starts[i], reader.cap_, reader.compat_ }, {} };
+                        if (!entryReader.process_entry(entryKeyHash, entry)) {
+                            std::lock_guard guard(failed_lock);
+                            if (i < failed) {
+                                failed = i;
+                                failed_error = std::move(entryReader.error);
+                            }
+                            break;
+                        }
+                        items[i] = Pair{ std::move(entryKeyHash), std::move(entry) };
+                    }
+                }
+            };
+            std::vector<std::thread> pool;
+            for (size_t i = 1; i < workers; i++) {
+                pool.emplace_back(work);
+            }
+            work();
+            for (auto& thread : pool) {
+                thread.join();
+            }
+
+            if (failed != starts.size()) {
+                error.insert(error.end(), failed_error.begin(), failed_error.end());
+                return false;
+            }
+            reader.cur_ = end;
+            return true;
+        }
+
+        bool index_entries() noexcept {
+            uint32_t entryCount = 0;
+            std::vector<uint32_t> entryNameHashes;
+            bin_assert(reader.read(entryCount));
+            bin_assert(reader.read(entryNameHashes, entryCount));
+            index->entries.reserve(entryCount);
+            for (uint32_t entryNameHash : entryNameHashes) {
+                auto const start = reader.cur_;
+                uint32_t entryLength = 0;
+                uint32_t entryKeyHash = 0;
+                bin_assert(reader.read(entryLength));
+                bin_assert(entryLength >= sizeof(uint32_t));
+                bin_assert(reader.read(entryKeyHash));
+                bin_assert(reader.skip(entryLength - sizeof(uint32_t)));
+                index->entries.push_back({ entryKeyHash, entryNameHash, { start, reader.cur_ } });
+            }
+            for (size_t i = 0; i != index->entries.size(); i++) {
+                auto const& entry = index->entries[i];
+                index->by_key.emplace(entry.key, i);
+                index->by_name[entry.name].push_back(i);
+            }
+            return true;
+        }
+
+        static bool filter_match(std::vector<FNV1a> const& list, uint32_t hash) noexcept {
+            return list.empty() || std::any_of(list.begin(), list.end(), [hash](FNV1a const& item) {
+                return item.hash() == hash;
+            });
+        }
+
+        // Entries that don't match are skipped using their length prefix instead of being decoded
+        bool read_entries_filtered() noexcept {
+            uint32_t entryCount = 0;
+            std::vector<uint32_t> entryNameHashes;
+            bin_assert(reader.read(entryCount));
+            bin_assert(reader.read(entryNameHashes, entryCount));
+            std::vector<std::vector<FNV1a> const*> paths;
+            for (auto const& path : filter->fields) {
+                if (!path.empty()) {
+                    paths.push_back(&path);
+                }
+            }
+            Map entriesMap = { Type::HASH,  Type::EMBED, {} };
             for (uint32_t entryNameHash : entryNameHashes) {
+                auto const start = reader.cur_;
+                uint32_t entryLength = 0;
                 Hash entryKeyHash = {};
+                bin_assert(reader.read(entryLength));
+                size_t position = reader.position();
+                if (!filter_match(filter->classes, entryNameHash)) {
+                    bin_assert(reader.skip(entryLength));
+                    continue;
+                }
+                bin_assert(reader.read(entryKeyHash.value));
+                if (!filter_match(filter->entries, entryKeyHash.value.hash())) {
+                    bin_assert(reader.skip(position + entryLength - reader.position()));
+                    continue;
+                }
                 Embed entry = { { entryNameHash }, {} };
-                bin_assert(read_entry(entryKeyHash, entry));
+                if (paths.empty()) {
+                    reader.cur_ = start;
+                    bin_assert(read_entry(entryKeyHash, entry));
+                } else {
+                    bin_assert(read_fields_filtered(entry.items, paths, 0));
+                    bin_assert(reader.position() == position + entryLength);
+                }
                 entriesMap.items.emplace_back(Pair{ std::move(entryKeyHash), std::move(entry) });
             }
             bin.sections.emplace("entries", std::move(entriesMap));
             return true;
         }
 
+        // Decodes fields whose path is selected, descends into embeds and pointers on the way to selected fields
+        bool read_fields_filtered(FieldList& items, std::vector<std::vector<FNV1a> const*> const& paths, size_t depth) noexcept {
+            uint16_t count = 0;
+            bin_assert(reader.read(count));
+            for (size_t i = 0; i != count; i++) {
+                uint32_t name = 0;
+                Type type = {};
+                bin_assert(reader.read(name));
+                bin_assert(reader.read(type));
+                std::vector<std::vector<FNV1a> const*> matched;
+                bool selected = false;
+                for (auto path : paths) {
+                    if ((*path)[depth].hash() == name) {
+                        matched.push_back(path);
+                        selected = selected || path->size() == depth + 1;
+                    }
+                }
+                if (selected) {
+                    auto& [key, item] = items.emplace_back();
+                    key = name;
+                    bin_assert(read_value_of(item, type));
+                } else if (!matched.empty() && type == Type::EMBED) {
+                    Embed value = {};
+                    bin_assert(read_class_filtered(value, matched, depth + 1));
+                    items.emplace_back(Field{ name, std::move(value) });
+                } else if (!matched.empty() && type == Type::POINTER) {
+                    Pointer value = {};
+                    bin_assert(read_class_filtered(value, matched, depth + 1));
+                    items.emplace_back(Field{ name, std::move(value) });
+                } else {
+                    bin_assert(skip_value(type));
+                }
+            }
+            return true;
+        }
+
+        template<typename T>
+        bool read_class_filtered(T& value, std::vector<std::vector<FNV1a> const*> const& paths, size_t depth) noexcept {
+            uint32_t size = 0;
+            bin_assert(reader.read(value.name));
+            if (T::type == Type::POINTER && value.name.hash() == 0) {
+                return true;
+            }
+            bin_assert(reader.read(size));
+            size_t position = reader.position();
+            bin_assert(read_fields_filtered(value.items, paths, depth));
+            bin_assert(reader.position() == position + size);
+            return true;
+        }
+
+        // Skips value using length prefixes where format has them, contents are not checked
+        bool skip_value(Type type) noexcept {
+            auto const value_end = impl_binary_skip::skip_value(type, reader.cur_, reader.cap_, reader.compat_);
+            bin_assert(value_end);
+            reader.cur_ = value_end;
+            return true;
+        }
+
         bool read_entry(Hash& entryKeyHash, Embed& entry) noexcept {
             uint32_t entryLength = 0;
             uint16_t count = 0;
@@ -190,6 +369,18 @@ namespace ritobin::io::impl_binary_read {
             bin_assert(reader.read(patchCount));
             Map patchMap = { Type::HASH,  Type::EMBED, {} };
             for (size_t i = {}; i != patchCount; i++) {
+                if (filter && !filter->entries.empty()) {
+                    uint32_t patchKeyHash = 0;
+                    uint32_t patchLength = 0;
+                    auto const start = reader.cur_;
+                    bin_assert(reader.read(patchKeyHash));
+                    bin_assert(reader.read(patchLength));
+                    if (!filter_match(filter->entries, patchKeyHash)) {
+                        bin_assert(reader.skip(patchLength));
+                        continue;
+                    }
+                    reader.cur_ = start;
+                }
                 Hash entryKeyHash = {};
                 Embed entry = { { "patch" }, {} };
                 bin_assert(read_patch(entryKeyHash, entry));
@@ -216,11 +407,50 @@ namespace ritobin::io::impl_binary_read {
             return true;
         }
 
+        template<typename T>
+        void read_items_unchecked(ElementList& items, uint32_t count) noexcept {
+            items.resize(count);
+            for (auto& [item] : items) {
+                reader.read_unchecked(item.template emplace<T>().value);
+            }
+        }
+
+        // Items of fixed size are checked against buffer once and then read without per item checks or dispatch.
+        // When they don't fit items are left to be read one by one so errors are reported same as before.
+        bool try_read_fixed_items(ElementList& items, Type type, uint32_t count) noexcept {
+            using ReadItems = void (BinBinaryReader::*)(ElementList&, uint32_t) noexcept;
+            static constexpr auto table = []<typename...T>(std::variant<T...> const*) {
+                std::array<ReadItems, 256> table = {};
+                ([&table] {
+                    if constexpr (fixed_size(T::type) != 0) {
+                        table[static_cast<uint8_t>(T::type)] = &BinBinaryReader::read_items_unchecked<T>;
+                    }
+                }(), ...);
+                return table;
+            }(static_cast<Value const*>(nullptr));
+            auto const read_items = table[static_cast<uint8_t>(type)];
+            if (!read_items || static_cast<size_t>(count) * fixed_size(type) > static_cast<size_t>(reader.cap_ - reader.cur_)) {
+                return false;
+            }
+            (this->*read_items)(items, count);
+            return true;
+        }
+
+        template<typename T>
+        bool read_value_as(Value& value) noexcept {
+            return read_value_visit(value.emplace<T>());
+        }
+
+        // Jump table indexed by type instead of searching variant alternatives for it
         bool read_value_of(Value& value, Type type) noexcept {
-            value = ValueHelper::type_to_value(type);
-            return std::visit([this](auto&& value) {
-                return read_value_visit(std::forward<decltype(value)>(value));
-            }, value);
+            using ReadValue = bool (BinBinaryReader::*)(Value&) noexcept;
+            static constexpr auto table = []<typename...T>(std::variant<T...> const*) {
+                std::array<ReadValue, 256> table = {};
+                table.fill(&BinBinaryReader::read_value_as<None>);
+                ((table[static_cast<uint8_t>(T::type)] = &BinBinaryReader::read_value_as<T>), ...);
+                return table;
+            }(static_cast<Value const*>(nullptr));
+            return (this->*table[static_cast<uint8_t>(type)])(value);
         }
 
         bool read_value_visit(None&) noexcept { 
@@ -287,6 +517,9 @@ namespace ritobin::io::impl_binary_read {
             bin_assert(reader.read(size));
             size_t position = reader.position();
             bin_assert(reader.read(count));
+            if (try_read_fixed_items(value.items, value.valueType, count)) {
+                count = 0;
+            }
             for (size_t i = 0; i != count; i++) {
                 auto& [item] = value.items.emplace_back();
                 bin_assert(read_value_of(item, value.valueType));
@@ -303,6 +536,9 @@ namespace ritobin::io::impl_binary_read {
             bin_assert(reader.read(size));
             size_t position = reader.position();
             bin_assert(reader.read(count));
+            if (try_read_fixed_items(value.items, value.valueType, count)) {
+                count = 0;
+            }
             for (size_t i = 0; i != count; i++) {
                 auto& [item] = value.items.emplace_back();
                 bin_assert(read_value_of(item, value.valueType));
@@ -341,7 +577,7 @@ namespace ritobin::io::impl_binary_read {
             for(auto e = error.crbegin(); e != error.crend(); e++) {
                 trace.append(e->first);
                 trace.append(" @ ");
-                trace.append(std::to_string(reader.beg_ - e->second));
+                trace.append(std::to_string(e->second - reader.beg_));
                 trace.append("\n");
             }
             return trace;
@@ -351,14 +587,439 @@ namespace ritobin::io::impl_binary_read {
 
 namespace ritobin::io {
     using namespace impl_binary_read;
+    using compat_impl::visit_compat;
 
     std::string read_binary(Bin& value, std::span<char const> data, BinCompat const* compat) noexcept {
         auto const begin = data.data();
         auto const end = data.data() + data.size();
-        BinBinaryReader reader = { value, { begin, begin, end, compat }, {} };
+        return visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            BinBinaryReader<Compat> reader = { value, { begin, begin, end, compat }, {} };
+            if (!reader.process()) {
+                return reader.trace_error();
+            }
+            return {};
+        });
+    }
+
+    std::string read_binary(Bin& value, std::span<char const> data, BinCompat const* compat, size_t threads) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        if (threads == 0) {
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        return visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            BinBinaryReader<Compat> reader = { value, { begin, begin, end, compat }, {}, nullptr, threads };
+            if (!reader.process()) {
+                return reader.trace_error();
+            }
+            return {};
+        });
+    }
+
+    std::string read_binary(Bin& value, std::span<char const> data, BinCompat const* compat, BinFilter const& filter) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        return visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            BinBinaryReader<Compat> reader = { value, { begin, begin, end, compat }, {}, nullptr, 1, &filter };
+            if (!reader.process()) {
+                return reader.trace_error();
+            }
+            return {};
+        });
+    }
+
+    std::string read_binary(Bin& value, std::span<char const> data, BinCompat const* compat, BinSource& source) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        source = { compat };
+        return visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            BinBinaryReader<Compat> reader = { value, { begin, begin, end, compat }, {}, nullptr, 1, nullptr, &source };
+            if (!reader.process()) {
+                return reader.trace_error();
+            }
+            return {};
+        });
+    }
+
+    Embed* BinSource::edit(Bin& bin, FNV1a const& key) {
+        auto const section = bin.sections.find("entries");
+        if (section == bin.sections.end()) {
+            return nullptr;
+        }
+        auto const map = std::get_if<Map>(&section->second);
+        if (!map) {
+            return nullptr;
+        }
+        for (auto& [entryKey, entryValue] : map->items) {
+            auto const hash = std::get_if<Hash>(&entryKey);
+            auto const value = std::get_if<Embed>(&entryValue);
+            if (hash && value && hash->value.hash() == key.hash()) {
+                touch(key);
+                return value;
+            }
+        }
+        return nullptr;
+    }
+
+    BinSource::Entry const* BinSource::find_clean(FNV1a const& key) const noexcept {
+        if (dirty.contains(key.hash())) {
+            return nullptr;
+        }
+        if (auto i = entries.find(key.hash()); i != entries.end()) {
+            return &i->second;
+        }
+        return nullptr;
+    }
+
+    std::string verify_binary(std::span<char const> data, BinCompat const* compat) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        BinBinaryWalker<BinNullVisitor> walker = { {}, { begin, begin, end, compat }, {} };
+        if (!walker.process()) {
+            return walker.trace_error();
+        }
+        return {};
+    }
+
+    std::string transcode_binary(std::vector<char>& out, std::span<char const> data, BinCompat const* from, BinCompat const* to) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        out.assign(begin, end);
+        BinBinaryWalker<BinTranscodeVisitor> walker = { { {}, begin, out.data(), to }, { begin, begin, end, from }, {} };
+        if (!walker.process()) {
+            out.clear();
+            return walker.trace_error();
+        }
+        // Bin doesn't keep fields between PTCH and PROP, write_binary always emits them as 1 and 0
+        if (out.size() >= sizeof(uint32_t) * 3 && std::string_view(out.data(), 4) == "PTCH") {
+            auto const fields = std::array<uint32_t, 2>{ 1, 0 };
+            memcpy(out.data() + sizeof(uint32_t), fields.data(), sizeof(fields));
+        }
+        return {};
+    }
+
+    std::string index_binary(BinIndex& index, std::span<char const> data, BinCompat const* compat) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        index = { data, compat };
+        BinBinaryReader<BinCompat> reader = { index.header, { begin, begin, end, compat }, {}, &index };
         if (!reader.process()) {
             return reader.trace_error();
         }
         return {};
     }
+
+    BinIndex::Entry const* BinIndex::find(FNV1a const& key) const noexcept {
+        if (auto i = by_key.find(key.hash()); i != by_key.end()) {
+            return &entries[i->second];
+        }
+        return nullptr;
+    }
+
+    std::span<size_t const> BinIndex::find_class(FNV1a const& name) const noexcept {
+        if (auto i = by_name.find(name.hash()); i != by_name.end()) {
+            return i->second;
+        }
+        return {};
+    }
+
+    std::string BinIndex::read_entry(Entry const& entry, Hash& key, Embed& value) const noexcept {
+        auto const begin = data.data();
+        auto const end = entry.data.data() + entry.data.size();
+        value = { { entry.name }, {} };
+        return visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            Bin unused = {};
+            BinBinaryReader<Compat> reader = { unused, { begin, entry.data.data(), end, compat }, {} };
+            if (!reader.process_entry(key, value)) {
+                return reader.trace_error();
+            }
+            return {};
+        });
+    }
+
+    std::string visit_binary(BinVisitor& visitor, std::span<char const> data, BinCompat const* compat) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        BinBinaryWalker<BinVisitor&> walker = { visitor, { begin, begin, end, compat }, {} };
+        if (!walker.process()) {
+            return walker.trace_error();
+        }
+        return {};
+    }
+
+    std::string BinEntryReader::open(std::span<char const> data, BinCompat const* compat) noexcept {
+        *this = {};
+        data_ = data;
+        compat_ = compat;
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        BinBinaryReader<BinCompat> reader = { header, { begin, begin, end, compat }, {} };
+        if (!reader.process_header(is_patch_, count_, names_)) {
+            error = reader.trace_error();
+            return error;
+        }
+        cur_ = reader.reader.cur_;
+        done_ = false;
+        return {};
+    }
+
+    bool BinEntryReader::next() noexcept {
+        if (done_) {
+            return false;
+        }
+        auto const begin = data_.data();
+        auto const end = data_.data() + data_.size();
+        if (index_ == count_) {
+            done_ = true;
+            BinBinaryReader<BinCompat> reader = { header, { begin, cur_, end, compat_ }, {} };
+            if (!reader.process_footer(is_patch_)) {
+                error = reader.trace_error();
+            }
+            return false;
+        }
+        uint32_t name = {};
+        memcpy(&name, names_ + sizeof(uint32_t) * index_, sizeof(uint32_t));
+        entry = { {}, { { name }, {} } };
+        error = visit_compat(compat_, [&]<typename Compat>(Compat const* compat) -> std::string {
+            Bin unused = {};
+            BinBinaryReader<Compat> reader = { unused, { begin, cur_, end, compat }, {} };
+            if (!reader.process_entry(entry.key, entry.value)) {
+                return reader.trace_error();
+            }
+            cur_ = reader.reader.cur_;
+            return {};
+        });
+        if (!error.empty()) {
+            done_ = true;
+            return false;
+        }
+        ++index_;
+        return true;
+    }
+
+    BinStreamReader::BinStreamReader(BinCompat const* compat, EntryCallback on_entry) noexcept
+        : compat_(compat), on_entry_(std::move(on_entry)) {}
+
+    std::string BinStreamReader::feed(std::span<char const> data) noexcept {
+        auto cur = data.data();
+        auto const end = data.data() + data.size();
+        while (stage_ != Stage::Done || cur != end) {
+            if (!buffer_.empty()) {
+                // top up partial item only with as many bytes as it needs
+                auto need = item_size(buffer_);
+                while (need > buffer_.size() && cur != end) {
+                    auto const take = std::min(need - buffer_.size(), static_cast<size_t>(end - cur));
+                    buffer_.insert(buffer_.end(), cur, cur + take);
+                    cur += take;
+                    need = item_size(buffer_);
+                }
+                if (need > buffer_.size()) {
+                    return {};
+                }
+                if (auto error = process_item(buffer_); !error.empty()) {
+                    return error;
+                }
+                buffer_.clear();
+                continue;
+            }
+            auto const need = item_size({ cur, end });
+            if (need > static_cast<size_t>(end - cur)) {
+                buffer_.assign(cur, end);
+                return {};
+            }
+            if (stage_ == Stage::Done) {
+                return "Data past end of file @ " + std::to_string(offset_) + "\n";
+            }
+            if (auto error = process_item({ cur, need }); !error.empty()) {
+                return error;
+            }
+            cur += need;
+        }
+        return {};
+    }
+
+    std::string BinStreamReader::finish() const noexcept {
+        if (stage_ != Stage::Done) {
+            return "Unexpected end of file @ " + std::to_string(offset_ + buffer_.size()) + "\n";
+        }
+        return {};
+    }
+
+    // Number of bytes current item takes, or number of bytes needed to find that out
+    size_t BinStreamReader::item_size(std::span<char const> data) const noexcept {
+        auto const prefixed = [&data](size_t prefix, size_t skip) -> size_t {
+            if (data.size() < prefix) {
+                return prefix;
+            }
+            size_t length = 0;
+            if (prefix - skip == sizeof(uint16_t)) {
+                uint16_t value = {};
+                memcpy(&value, data.data() + skip, sizeof(value));
+                length = value;
+            } else {
+                uint32_t value = {};
+                memcpy(&value, data.data() + skip, sizeof(value));
+                length = value;
+            }
+            return prefix + length;
+        };
+        switch (stage_) {
+        case Stage::Magic:
+            if (data.size() < 4) {
+                return 4;
+            }
+            return std::string_view{ data.data(), 4 } == "PTCH" ? 20 : 8;
+        case Stage::LinkedCount:
+        case Stage::EntryCount:
+        case Stage::PatchCount:
+            return sizeof(uint32_t);
+        case Stage::Linked:
+            return prefixed(sizeof(uint16_t), 0);
+        case Stage::EntryNames:
+            return sizeof(uint32_t) * left_;
+        case Stage::Entries:
+            return prefixed(sizeof(uint32_t), 0);
+        case Stage::Patches:
+            return prefixed(sizeof(uint32_t) * 2, sizeof(uint32_t));
+        case Stage::Done:
+            return 0;
+        }
+        return 0;
+    }
+
+    std::string BinStreamReader::process_item(std::span<char const> data) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        auto const trace_error = [this, begin](std::vector<std::pair<std::string, char const*>> const& error) {
+            std::string trace;
+            for(auto e = error.crbegin(); e != error.crend(); e++) {
+                trace.append(e->first);
+                trace.append(" @ ");
+                trace.append(std::to_string(offset_ + (e->second - begin)));
+                trace.append("\n");
+            }
+            return trace;
+        };
+        BinaryReader<> reader = { begin, begin, end, compat_ };
+        switch (stage_) {
+        case Stage::Magic: {
+            std::array<char, 4> magic = {};
+            (void)reader.read(magic);
+            if (magic == std::array{ 'P', 'T', 'C', 'H' }) {
+                uint64_t unk = {};
+                (void)reader.read(unk);
+                (void)reader.read(magic);
+                is_patch_ = true;
+            }
+            if (magic != std::array{ 'P', 'R', 'O', 'P' }) {
+                return trace_error({ { "magic == std::array{ 'P', 'R', 'O', 'P' }", reader.cur_ - 4 } });
+            }
+            (void)reader.read(version_);
+            header.sections.clear();
+            header.sections.emplace("type", String{ is_patch_ ? "PTCH" : "PROP" });
+            header.sections.emplace("version", U32{ version_ });
+            break;
+        }
+        case Stage::LinkedCount:
+            (void)reader.read(left_);
+            header.sections.emplace("linked", List{ Type::STRING, {} });
+            break;
+        case Stage::Linked: {
+            String linked = {};
+            (void)reader.read(linked.value);
+            std::get<List>(header.sections["linked"]).items.emplace_back(Element{ std::move(linked) });
+            --left_;
+            break;
+        }
+        case Stage::EntryCount:
+            (void)reader.read(left_);
+            header.sections.emplace("entries", Map{ Type::HASH, Type::EMBED, {} });
+            break;
+        case Stage::EntryNames:
+            (void)reader.read(names_, left_);
+            break;
+        case Stage::Entries: {
+            Hash entryKeyHash = {};
+            Embed entry = { { names_[names_.size() - left_] }, {} };
+            auto error = visit_compat(compat_, [&]<typename Compat>(Compat const* compat) -> std::string {
+                Bin unused = {};
+                BinBinaryReader<Compat> entryReader = { unused, { begin, begin, end, compat }, {} };
+                if (!entryReader.process_entry(entryKeyHash, entry)) {
+                    return trace_error(entryReader.error);
+                }
+                return {};
+            });
+            if (!error.empty()) {
+                return error;
+            }
+            if (!on_entry_(entryKeyHash, entry)) {
+                return "Stopped by callback @ " + std::to_string(offset_) + "\n";
+            }
+            --left_;
+            break;
+        }
+        case Stage::PatchCount:
+            (void)reader.read(left_);
+            header.sections.emplace("patches", Map{ Type::HASH, Type::EMBED, {} });
+            break;
+        case Stage::Patches: {
+            Hash patchKeyHash = {};
+            Embed patch = { { "patch" }, {} };
+            Bin unused = {};
+            BinBinaryReader<BinCompat> patchReader = { unused, { begin, begin, end, compat_ }, {} };
+            if (!patchReader.process_patch(patchKeyHash, patch)) {
+                return trace_error(patchReader.error);
+            }
+            std::get<Map>(header.sections["patches"]).items.emplace_back(Pair{ std::move(patchKeyHash), std::move(patch) });
+            --left_;
+            break;
+        }
+        case Stage::Done:
+            break;
+        }
+        offset_ += data.size();
+        next_stage();
+        return {};
+    }
+
+    void BinStreamReader::next_stage() noexcept {
+        switch (stage_) {
+        case Stage::Magic:
+            if (version_ >= 2) {
+                stage_ = Stage::LinkedCount;
+                return;
+            }
+            stage_ = Stage::EntryCount;
+            return;
+        case Stage::LinkedCount:
+        case Stage::Linked:
+            if (left_ != 0) {
+                stage_ = Stage::Linked;
+                return;
+            }
+            stage_ = Stage::EntryCount;
+            return;
+        case Stage::EntryCount:
+            stage_ = Stage::EntryNames;
+            return;
+        case Stage::EntryNames:
+        case Stage::Entries:
+            if (left_ != 0) {
+                stage_ = Stage::Entries;
+                return;
+            }
+            stage_ = is_patch_ ? Stage::PatchCount : Stage::Done;
+            return;
+        case Stage::PatchCount:
+        case Stage::Patches:
+            if (left_ != 0) {
+                stage_ = Stage::Patches;
+                return;
+            }
+            stage_ = Stage::Done;
+            return;
+        case Stage::Done:
+            return;
+        }
+    }
 }
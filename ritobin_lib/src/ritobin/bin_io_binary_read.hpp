@@ -0,0 +1,445 @@
+#ifndef BIN_IO_BINARY_READ_HPP
+#define BIN_IO_BINARY_READ_HPP
+
+#include "bin_io.hpp"
+#include "bin_io_binary_skip.hpp"
+#include "bin_types_helper.hpp"
+#include "bin_view.hpp"
+
+#define bin_assert(...) do { \
+    if (auto start = reader.cur_; !(__VA_ARGS__)) { \
+        return fail_msg(#__VA_ARGS__, start); \
+    } } while(false)
+
+namespace ritobin::io::impl_binary_read {
+    // Compat can be concrete built-in compat so its type mapping gets inlined
+    template<typename Compat = BinCompat>
+    struct BinaryReader {
+        char const* const beg_;
+        char const* cur_;
+        char const* const cap_;
+        Compat const* const compat_;
+
+        inline constexpr size_t position() const noexcept {
+            return cur_ - beg_;
+        }
+
+        template<typename T>
+        inline bool read(T& value) noexcept {
+            static_assert(std::is_arithmetic_v<T>);
+            if (cur_ + sizeof(T) > cap_) {
+                return false;
+            }
+            memcpy(&value, cur_, sizeof(T));
+            cur_ += sizeof(T);
+            return true;
+        }
+
+        template<typename T, size_t SIZE>
+        bool read(std::array<T, SIZE>& value) noexcept {
+            static_assert(std::is_arithmetic_v<T>);
+            if (cur_ + sizeof(T) * SIZE > cap_) {
+                return false;
+            }
+            memcpy(value.data(), cur_, sizeof(T) * SIZE);
+            cur_ += sizeof(T) * SIZE;
+            return true;
+        }
+
+        template<typename T>
+        bool read(std::vector<T>& value, size_t size) noexcept {
+            static_assert(std::is_arithmetic_v<T>);
+            if (cur_ + sizeof(T) * size > cap_) {
+                return false;
+            }
+            value.resize(size);
+            memcpy(value.data(), cur_, sizeof(T) * size);
+            cur_ += sizeof(T) * size;
+            return true;
+        }
+
+        // Caller has already checked that value fits into buffer
+        template<typename T>
+        inline void read_unchecked(T& value) noexcept {
+            if constexpr (requires { typename T::storage_t; }) {
+                typename T::storage_t h = {};
+                memcpy(&h, cur_, sizeof(h));
+                cur_ += sizeof(h);
+                value = T{ h };
+            } else {
+                static_assert(std::is_trivially_copyable_v<T>);
+                memcpy(&value, cur_, sizeof(T));
+                cur_ += sizeof(T);
+            }
+        }
+
+        bool skip(size_t size) noexcept {
+            if (size > static_cast<size_t>(cap_ - cur_)) {
+                return false;
+            }
+            cur_ += size;
+            return true;
+        }
+
+        bool read(std::string& value) noexcept {
+            uint16_t size = {};
+            if (!read(size)) {
+                return false;
+            }
+            if (cur_ + size > cap_) {
+                return false;
+            }
+            value = { cur_, size };
+            cur_ += size;
+            return true;
+        }
+
+        bool read(std::string_view& value) noexcept {
+            uint16_t size = {};
+            if (!read(size)) {
+                return false;
+            }
+            if (cur_ + size > cap_) {
+                return false;
+            }
+            value = { cur_, size };
+            cur_ += size;
+            return true;
+        }
+
+        bool read(Type& value) noexcept {
+            uint8_t raw = {};
+            if (!read(raw)) {
+                return false;
+            }
+            return compat_->raw_to_type(raw, value);
+        }
+
+        bool read(FNV1a& value) noexcept {
+            uint32_t h;
+            if (!read(h)) {
+                return false;
+            }
+            value = FNV1a{ h };
+            return true;
+        }
+
+        bool read(XXH64& value) noexcept {
+            uint64_t h;
+            if (!read(h)) {
+                return false;
+            }
+            value = XXH64{ h };
+            return true;
+        }
+    };
+
+
+    using impl_binary_skip::fixed_size;
+
+    // Ignores all events, used when walker only validates
+    struct BinNullVisitor {
+        inline bool header(std::string_view, uint32_t) noexcept { return true; }
+        inline bool linked(std::string_view) noexcept { return true; }
+        inline bool begin_entries(uint32_t) noexcept { return true; }
+        inline bool end_entries() noexcept { return true; }
+        inline bool begin_entry(uint32_t, uint32_t, uint16_t) noexcept { return true; }
+        inline bool end_entry() noexcept { return true; }
+        inline bool begin_patches(uint32_t) noexcept { return true; }
+        inline bool end_patches() noexcept { return true; }
+        inline bool begin_patch(uint32_t, std::string_view, Type) noexcept { return true; }
+        inline bool end_patch() noexcept { return true; }
+        inline bool field(uint32_t, Type) noexcept { return true; }
+        inline bool value(ValueView const&) noexcept { return true; }
+        inline bool begin_class(Type, uint32_t, uint16_t) noexcept { return true; }
+        inline bool end_class() noexcept { return true; }
+        inline bool begin_list(Type, Type, uint32_t) noexcept { return true; }
+        inline bool end_list() noexcept { return true; }
+        inline bool begin_map(Type, Type, uint32_t) noexcept { return true; }
+        inline bool end_map() noexcept { return true; }
+    };
+
+    // Walks .bin structure with same checks as BinBinaryReader but without decoding any values
+    // Structure is reported to visitor as it is walked, visitor returning false stops the walk
+    template<typename Visitor>
+    struct BinBinaryWalker {
+        Visitor visitor;
+        BinaryReader<> reader;
+        std::vector<std::pair<std::string, char const*>> error;
+
+        bool process() noexcept {
+            bin_assert(walk_sections());
+            return true;
+        }
+
+        bool process_value(Type type) noexcept {
+            bin_assert(walk_value(type));
+            return true;
+        }
+
+    private:
+        bool fail_msg(char const* msg, char const* pos) noexcept {
+            error.emplace_back(msg, pos);
+            return false;
+        }
+
+        // Visitors that need to know where raw type bytes are can take them with raw_type
+        bool read_type(Type& type) noexcept {
+            auto const raw = reader.cur_;
+            if (!reader.read(type)) {
+                return false;
+            }
+            if constexpr (requires { visitor.raw_type(raw, type); }) {
+                return visitor.raw_type(raw, type);
+            } else {
+                return true;
+            }
+        }
+
+        bool walk_sections() noexcept {
+            std::array<char, 4> magic = {};
+            uint32_t version = 0;
+            bin_assert(reader.read(magic));
+            bool is_patch = false;
+            if (magic == std::array{ 'P', 'T', 'C', 'H' }) {
+                uint64_t unk = {};
+                bin_assert(reader.read(unk));
+                bin_assert(reader.read(magic));
+                is_patch = true;
+            }
+            bin_assert(magic == std::array{ 'P', 'R', 'O', 'P' });
+            bin_assert(reader.read(version));
+            bin_assert(visitor.header(is_patch ? "PTCH" : "PROP", version));
+            if (version >= 2) {
+                bin_assert(walk_linked());
+            }
+            if (is_patch && patches_first()) {
+                // entries are only skipped through their length prefixes to find patches and walked after them
+                auto const entries = reader.cur_;
+                bin_assert(skip_entries());
+                auto const patches = reader.cur_;
+                bin_assert(walk_patches());
+                auto const end = reader.cur_;
+                reader.cur_ = entries;
+                bin_assert(walk_entries());
+                bin_assert(reader.cur_ == patches);
+                reader.cur_ = end;
+            } else {
+                bin_assert(walk_entries());
+                if (is_patch) {
+                    bin_assert(walk_patches());
+                }
+            }
+            bin_assert(reader.cur_ == reader.cap_);
+            return true;
+        }
+
+        // Visitors that would have to hold entries until patches are written can ask for patches first
+        bool patches_first() noexcept {
+            if constexpr (requires { visitor.patches_first(); }) {
+                return visitor.patches_first();
+            } else {
+                return false;
+            }
+        }
+
+        bool walk_linked() noexcept {
+            uint32_t linkedFilesCount = {};
+            bin_assert(reader.read(linkedFilesCount));
+            for (uint32_t i = 0; i != linkedFilesCount; i++) {
+                std::string_view linked = {};
+                bin_assert(reader.read(linked));
+                bin_assert(visitor.linked(linked));
+            }
+            return true;
+        }
+
+        bool walk_entries() noexcept {
+            uint32_t entryCount = 0;
+            bin_assert(reader.read(entryCount));
+            auto const names = reader.cur_;
+            bin_assert(reader.skip(sizeof(uint32_t) * entryCount));
+            bin_assert(visitor.begin_entries(entryCount));
+            for (uint32_t i = 0; i != entryCount; i++) {
+                uint32_t entryNameHash = {};
+                memcpy(&entryNameHash, names + sizeof(uint32_t) * i, sizeof(uint32_t));
+                bin_assert(walk_entry(entryNameHash));
+            }
+            bin_assert(visitor.end_entries());
+            return true;
+        }
+
+        bool skip_entries() noexcept {
+            uint32_t entryCount = 0;
+            bin_assert(reader.read(entryCount));
+            bin_assert(reader.skip(sizeof(uint32_t) * entryCount));
+            for (uint32_t i = 0; i != entryCount; i++) {
+                uint32_t entryLength = 0;
+                bin_assert(reader.read(entryLength));
+                bin_assert(reader.skip(entryLength));
+            }
+            return true;
+        }
+
+        bool walk_entry(uint32_t entryNameHash) noexcept {
+            uint32_t entryLength = 0;
+            uint32_t entryKeyHash = 0;
+            bin_assert(reader.read(entryLength));
+            size_t position = reader.position();
+            uint16_t count = 0;
+            bin_assert(reader.read(entryKeyHash));
+            bin_assert(reader.read(count));
+            bin_assert(visitor.begin_entry(entryKeyHash, entryNameHash, count));
+            bin_assert(walk_fields(count));
+            bin_assert(reader.position() == position + entryLength);
+            bin_assert(visitor.end_entry());
+            return true;
+        }
+
+        bool walk_patches() noexcept {
+            uint32_t patchCount = {};
+            bin_assert(reader.read(patchCount));
+            bin_assert(visitor.begin_patches(patchCount));
+            for (uint32_t i = 0; i != patchCount; i++) {
+                bin_assert(walk_patch());
+            }
+            bin_assert(visitor.end_patches());
+            return true;
+        }
+
+        bool walk_patch() noexcept {
+            uint32_t patchKeyHash = 0;
+            uint32_t patchLength = 0;
+            bin_assert(reader.read(patchKeyHash));
+            bin_assert(reader.read(patchLength));
+            auto position = reader.position();
+            Type type = {};
+            std::string_view name = {};
+            bin_assert(read_type(type));
+            bin_assert(reader.read(name));
+            bin_assert(visitor.begin_patch(patchKeyHash, name, type));
+            bin_assert(walk_value(type));
+            bin_assert(reader.position() == position + patchLength);
+            bin_assert(visitor.end_patch());
+            return true;
+        }
+
+        bool walk_fields(uint16_t count) noexcept {
+            for (size_t i = 0; i != count; i++) {
+                uint32_t name = 0;
+                Type type = {};
+                bin_assert(reader.read(name));
+                bin_assert(read_type(type));
+                bin_assert(visitor.field(name, type));
+                bin_assert(walk_value(type));
+            }
+            return true;
+        }
+
+        bool walk_value(Type type) noexcept {
+            // not named start as bin_assert declares its own
+            auto const value_start = reader.cur_;
+            switch (type) {
+            case Type::NONE:
+                bin_assert(false);
+                return true;
+            case Type::STRING: {
+                std::string_view value = {};
+                bin_assert(reader.read(value));
+                bin_assert(visitor.value(ValueView{ type, value_start, reader.compat_ }));
+                return true;
+            }
+            case Type::POINTER:
+            case Type::EMBED: {
+                uint32_t name = 0;
+                uint32_t size = 0;
+                bin_assert(reader.read(name));
+                if (type == Type::POINTER && name == 0) {
+                    bin_assert(visitor.begin_class(type, name, 0));
+                    bin_assert(visitor.end_class());
+                    return true;
+                }
+                bin_assert(reader.read(size));
+                size_t position = reader.position();
+                uint16_t count = 0;
+                bin_assert(reader.read(count));
+                bin_assert(visitor.begin_class(type, name, count));
+                bin_assert(walk_fields(count));
+                bin_assert(reader.position() == position + size);
+                bin_assert(visitor.end_class());
+                return true;
+            }
+            case Type::OPTION: {
+                Type valueType = {};
+                uint8_t count = 0;
+                bin_assert(read_type(valueType));
+                bin_assert(!ValueHelper::is_container(valueType));
+                bin_assert(reader.read(count));
+                bin_assert(visitor.begin_list(type, valueType, count != 0 ? 1 : 0));
+                if (count != 0) {
+                    bin_assert(walk_value(valueType));
+                }
+                bin_assert(visitor.end_list());
+                return true;
+            }
+            case Type::LIST:
+            case Type::LIST2: {
+                Type valueType = {};
+                uint32_t size = 0;
+                uint32_t count = 0;
+                bin_assert(read_type(valueType));
+                bin_assert(!ValueHelper::is_container(valueType));
+                bin_assert(reader.read(size));
+                size_t position = reader.position();
+                bin_assert(reader.read(count));
+                bin_assert(visitor.begin_list(type, valueType, count));
+                for (size_t i = 0; i != count; i++) {
+                    bin_assert(walk_value(valueType));
+                }
+                bin_assert(reader.position() == position + size);
+                bin_assert(visitor.end_list());
+                return true;
+            }
+            case Type::MAP: {
+                Type keyType = {};
+                Type valueType = {};
+                uint32_t size = 0;
+                uint32_t count = 0;
+                bin_assert(read_type(keyType));
+                bin_assert(ValueHelper::is_primitive(keyType));
+                bin_assert(read_type(valueType));
+                bin_assert(!ValueHelper::is_container(valueType));
+                bin_assert(reader.read(size));
+                size_t position = reader.position();
+                bin_assert(reader.read(count));
+                bin_assert(visitor.begin_map(keyType, valueType, count));
+                for (size_t i = 0; i != count; i++) {
+                    bin_assert(walk_value(keyType));
+                    bin_assert(walk_value(valueType));
+                }
+                bin_assert(reader.position() == position + size);
+                bin_assert(visitor.end_map());
+                return true;
+            }
+            default:
+                bin_assert(reader.skip(fixed_size(type)));
+                bin_assert(visitor.value(ValueView{ type, value_start, reader.compat_ }));
+                return true;
+            }
+        }
+
+    public:
+        std::string trace_error() noexcept {
+            std::string trace;
+            for(auto e = error.crbegin(); e != error.crend(); e++) {
+                trace.append(e->first);
+                trace.append(" @ ");
+                trace.append(std::to_string(e->second - reader.beg_));
+                trace.append("\n");
+            }
+            return trace;
+        }
+    };
+}
+
+#endif // BIN_IO_BINARY_READ_HPP
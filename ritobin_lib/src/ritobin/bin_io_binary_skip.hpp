@@ -0,0 +1,126 @@
+#ifndef BIN_IO_BINARY_SKIP_HPP
+#define BIN_IO_BINARY_SKIP_HPP
+
+#include "bin_io.hpp"
+#include "bin_types_helper.hpp"
+#include <cstring>
+
+namespace ritobin::io::impl_binary_skip {
+    // Size of values that are always encoded with same number of bytes, 0 otherwise
+    inline constexpr size_t fixed_size(Type type) noexcept {
+        switch (type) {
+        case Type::BOOL:
+        case Type::I8:
+        case Type::U8:
+        case Type::FLAG:
+            return 1;
+        case Type::I16:
+        case Type::U16:
+            return 2;
+        case Type::I32:
+        case Type::U32:
+        case Type::F32:
+        case Type::RGBA:
+        case Type::HASH:
+        case Type::LINK:
+            return 4;
+        case Type::I64:
+        case Type::U64:
+        case Type::VEC2:
+        case Type::FILE:
+            return 8;
+        case Type::VEC3:
+            return 12;
+        case Type::VEC4:
+            return 16;
+        case Type::MTX44:
+            return 64;
+        default:
+            return 0;
+        }
+    }
+
+    // Skips encoded value using length prefixes where format has them, contents are not checked.
+    // Returns where value ends or nullptr when it doesn't fit before cap or one of its type bytes is invalid.
+    // Data that has already been validated is skipped with Checked off, cap is ignored then.
+    template<bool Checked = true, typename Compat = BinCompat>
+    inline char const* skip_value(Type type, char const* cur, char const* cap, Compat const* compat) noexcept {
+        auto const fits = [&](size_t size) noexcept {
+            return !Checked || static_cast<size_t>(cap - cur) >= size;
+        };
+        auto const valid_type = [&](size_t offset, Type& result) noexcept {
+            return compat->raw_to_type(static_cast<uint8_t>(cur[offset]), result) || !Checked;
+        };
+        auto const skip_prefixed = [&](size_t header) noexcept -> char const* {
+            uint32_t size = 0;
+            if (!fits(header + sizeof(uint32_t))) {
+                return nullptr;
+            }
+            memcpy(&size, cur + header, sizeof(uint32_t));
+            cur += header + sizeof(uint32_t);
+            return fits(size) ? cur + size : nullptr;
+        };
+        switch (type) {
+        case Type::NONE:
+            return nullptr;
+        case Type::STRING: {
+            uint16_t size = 0;
+            if (!fits(sizeof(uint16_t))) {
+                return nullptr;
+            }
+            memcpy(&size, cur, sizeof(uint16_t));
+            cur += sizeof(uint16_t);
+            return fits(size) ? cur + size : nullptr;
+        }
+        case Type::POINTER:
+        case Type::EMBED: {
+            uint32_t name = 0;
+            if (!fits(sizeof(uint32_t))) {
+                return nullptr;
+            }
+            memcpy(&name, cur, sizeof(uint32_t));
+            if (type == Type::POINTER && name == 0) {
+                return cur + sizeof(uint32_t);
+            }
+            return skip_prefixed(sizeof(uint32_t));
+        }
+        case Type::OPTION: {
+            Type valueType = {};
+            if (!fits(sizeof(uint8_t) * 2) || !valid_type(0, valueType)) {
+                return nullptr;
+            }
+            if (Checked && ValueHelper::is_container(valueType)) {
+                return nullptr;
+            }
+            if (cur[1] == 0) {
+                return cur + sizeof(uint8_t) * 2;
+            }
+            return skip_value<Checked>(valueType, cur + sizeof(uint8_t) * 2, cap, compat);
+        }
+        case Type::LIST:
+        case Type::LIST2: {
+            if constexpr (Checked) {
+                Type valueType = {};
+                if (!fits(sizeof(uint8_t)) || !valid_type(0, valueType)) {
+                    return nullptr;
+                }
+            }
+            return skip_prefixed(sizeof(uint8_t));
+        }
+        case Type::MAP: {
+            if constexpr (Checked) {
+                Type keyType = {};
+                Type valueType = {};
+                if (!fits(sizeof(uint8_t) * 2) || !valid_type(0, keyType) || !valid_type(1, valueType)) {
+                    return nullptr;
+                }
+            }
+            return skip_prefixed(sizeof(uint8_t) * 2);
+        }
+        default:
+            return fits(fixed_size(type)) ? cur + fixed_size(type) : nullptr;
+        }
+    }
+}
+
+#endif // BIN_IO_BINARY_SKIP_HPP
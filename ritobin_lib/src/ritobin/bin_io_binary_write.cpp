@@ -1,54 +1,273 @@
 #include "bin_io.hpp"
 #include "bin_types_helper.hpp"
 #include "bin_numconv.hpp"
+#include "bin_io_binary_compat.hpp"
+#include "bin_io_binary_skip.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <thread>
 
 #define bin_assert(...) do { \
     if(!(__VA_ARGS__)) { \
         return fail_msg(#__VA_ARGS__ "\n"); \
     } } while(false)
 
+// Primitive writes are a bounds check and a store, with every compat instantiated in here
+// they would otherwise easily end up as calls
+#ifdef _MSC_VER
+#define bin_write_inline __forceinline
+#else
+#define bin_write_inline inline __attribute__((always_inline))
+#endif
+
 
 namespace ritobin::io::impl_binary_write {
+    using impl_binary_skip::fixed_size;
+
+    // Computes exact encoded size without writing anything or checking values,
+    // length of every length prefixed value is recorded in same order writer emits them
+    struct BinarySizer {
+        std::vector<uint32_t>& sizes_;
+
+        size_t entry(Embed const& value) noexcept {
+            return prefixed([&] { return sizeof(uint32_t) + fields(value.items); });
+        }
+
+        size_t patch(Embed const& value) noexcept {
+            auto const name = value.find_field({"path"});
+            auto const item = value.find_field({"value"});
+            if (!name || !item || !std::holds_alternative<String>(name->value)) {
+                // only key gets written before writer notices
+                return sizeof(uint32_t);
+            }
+            return sizeof(uint32_t) + prefixed([&] {
+                return sizeof(uint8_t) + size(name->value) + size(item->value);
+            });
+        }
+
+        size_t size(Value const& value) noexcept {
+            return std::visit([this](auto const& value) {
+                return size_visit(value);
+            }, value);
+        }
+
+    private:
+        template<typename F>
+        size_t prefixed(F&& contents) noexcept {
+            auto const index = sizes_.size();
+            sizes_.push_back(0);
+            auto const size = contents();
+            sizes_[index] = static_cast<uint32_t>(size);
+            return sizeof(uint32_t) + size;
+        }
+
+        size_t fields(FieldList const& items) noexcept {
+            size_t result = sizeof(uint16_t);
+            for (auto const& [name, item] : items) {
+                result += sizeof(uint32_t) + sizeof(uint8_t) + size(item);
+            }
+            return result;
+        }
+
+        size_t elements(ElementList const& items, Type type) noexcept {
+            if (auto const fixed = fixed_size(type)) {
+                return fixed * items.size();
+            }
+            size_t result = 0;
+            for (auto const& [item] : items) {
+                result += size(item);
+            }
+            return result;
+        }
+
+        size_t size_visit(String const& value) noexcept {
+            return sizeof(uint16_t) + value.value.size();
+        }
+
+        size_t size_visit(Embed const& value) noexcept {
+            return sizeof(uint32_t) + prefixed([&] { return fields(value.items); });
+        }
+
+        size_t size_visit(Pointer const& value) noexcept {
+            if (value.name.hash() == 0) {
+                return sizeof(uint32_t);
+            }
+            return sizeof(uint32_t) + prefixed([&] { return fields(value.items); });
+        }
+
+        size_t size_visit(List const& value) noexcept {
+            return sizeof(uint8_t) + prefixed([&] {
+                return sizeof(uint32_t) + elements(value.items, value.valueType);
+            });
+        }
+
+        size_t size_visit(List2 const& value) noexcept {
+            return sizeof(uint8_t) + prefixed([&] {
+                return sizeof(uint32_t) + elements(value.items, value.valueType);
+            });
+        }
+
+        size_t size_visit(Map const& value) noexcept {
+            return sizeof(uint8_t) * 2 + prefixed([&] {
+                auto const fixed_key = fixed_size(value.keyType);
+                auto const fixed_value = fixed_size(value.valueType);
+                if (fixed_key && fixed_value) {
+                    return sizeof(uint32_t) + (fixed_key + fixed_value) * value.items.size();
+                }
+                size_t result = sizeof(uint32_t);
+                for (auto const& [key, item] : value.items) {
+                    result += size(key) + size(item);
+                }
+                return result;
+            });
+        }
+
+        size_t size_visit(Option const& value) noexcept {
+            return sizeof(uint8_t) * 2 + elements(value.items, value.valueType);
+        }
+
+        template<typename T>
+        size_t size_visit(T const&) noexcept {
+            return fixed_size(T::type);
+        }
+    };
+
+    // Stores straight into memory, each entry is sized right before it is written so output only grows
+    // or gets flushed between entries and no length needs to be patched afterwards.
+    // When lengths are patched instead nothing gets sized upfront, every length is filled in once its contents
+    // are written and vector grows on write. Sizing costs about as much as writing so this is faster whenever
+    // whole output ends up in one vector anyway.
+    template<typename Compat>
     struct BinaryWriter {
-        std::vector<char>& buffer_;
-        BinCompat const* const compat_;
+        Compat const* const compat_;
+        // Grown when entry doesn't fit
+        std::vector<char>* vector_ = {};
+        // Buffer is flushed to it when entry doesn't fit
+        std::FILE* file_ = {};
+        char* beg_ = {};
+        char* cur_ = {};
+        char* cap_ = {};
+        size_t flushed_ = {};
+        std::vector<uint32_t> sizes_ = {};
+        uint32_t const* next_size_ = {};
+        bool patch_lengths_ = {};
 
-        bool write_at(size_t offset, size_t value) noexcept {
-            auto const tmp = static_cast<uint32_t>(value);
-            memcpy(buffer_.data() + offset, &tmp, sizeof(uint32_t));
+        BinarySizer sizer() noexcept {
+            sizes_.clear();
+            return { sizes_ };
+        }
+
+        [[nodiscard]] bool reserve(size_t size) noexcept {
+            next_size_ = sizes_.data();
+            if (static_cast<size_t>(cap_ - cur_) >= size) {
+                return true;
+            }
+            if (file_) {
+                if (!flush()) {
+                    return false;
+                }
+                if (static_cast<size_t>(cap_ - cur_) >= size) {
+                    return true;
+                }
+            }
+            if (patch_lengths_) {
+                grow(size);
+                return true;
+            }
+            if (!vector_) {
+                return false;
+            }
+            auto const used = static_cast<size_t>(cur_ - beg_);
+            vector_->resize(std::max(used + size, vector_->size() * 2));
+            beg_ = vector_->data();
+            cur_ = beg_ + used;
+            cap_ = beg_ + vector_->size();
             return true;
         }
 
-        template<typename T, size_t S>
-        void write(std::array<T, S> const& value) noexcept {
-            static_assert(std::is_arithmetic_v<T>);
-            char buffer[sizeof(T) * S];
-            memcpy(buffer, value.data(), sizeof(T) * S);
-            buffer_.insert(buffer_.end(), buffer, buffer + sizeof(T) * S);
+        [[nodiscard]] bool reserve_entry(Embed const& value) noexcept {
+            return patch_lengths_ || reserve(sizer().entry(value));
+        }
+
+        [[nodiscard]] bool reserve_patch(Embed const& value) noexcept {
+            return patch_lengths_ || reserve(sizer().patch(value));
+        }
+
+        [[nodiscard]] bool reserve_value(Value const& value) noexcept {
+            return patch_lengths_ || reserve(sizeof(uint8_t) + sizer().size(value));
+        }
+
+        [[nodiscard]] bool flush() noexcept {
+            auto const used = static_cast<size_t>(cur_ - beg_);
+            if (fwrite(beg_, 1, used, file_) != used) {
+                return false;
+            }
+            flushed_ += used;
+            cur_ = beg_;
+            return true;
+        }
+
+        [[nodiscard]] bool finish() noexcept {
+            if (file_) {
+                return flush() && fflush(file_) == 0;
+            }
+            if (vector_) {
+                vector_->resize(position());
+            }
+            return true;
         }
 
-        void write(std::vector<uint32_t> const& value, size_t offset) noexcept {
-            auto const size = sizeof(uint32_t) * value.size();
-            memcpy(buffer_.data() + offset, value.data(), size);
+        void write_at(size_t offset, uint32_t value) noexcept {
+            assert(offset >= flushed_ && offset - flushed_ + sizeof(uint32_t) <= static_cast<size_t>(cur_ - beg_));
+            memcpy(beg_ + (offset - flushed_), &value, sizeof(uint32_t));
         }
 
         void skip(size_t size) noexcept {
-            buffer_.insert(buffer_.end(), size, '\x00');
+            ensure(size);
+            cur_ += size;
+        }
+
+        // Returns offset that has to be given back to end_length once contents are written
+        bin_write_inline size_t write_length() noexcept {
+            auto const offset = position();
+            if (patch_lengths_) {
+                write(uint32_t{});
+                return offset;
+            }
+            assert(next_size_ < sizes_.data() + sizes_.size());
+            write(*next_size_++);
+            return offset;
+        }
+
+        bin_write_inline void end_length(size_t offset) noexcept {
+            if (patch_lengths_) {
+                write_at(offset, static_cast<uint32_t>(position() - offset - sizeof(uint32_t)));
+            }
+        }
+
+        template<typename T, size_t S>
+        bin_write_inline void write(std::array<T, S> const& value) noexcept {
+            static_assert(std::is_arithmetic_v<T>);
+            ensure(sizeof(T) * S);
+            memcpy(cur_, value.data(), sizeof(T) * S);
+            cur_ += sizeof(T) * S;
         }
 
         template<typename T>
-        void write(T value) noexcept {
+        bin_write_inline void write(T value) noexcept {
             static_assert(std::is_arithmetic_v<T>);
-            char buffer[sizeof(value)];
-            memcpy(buffer, &value, sizeof(value));
-            buffer_.insert(buffer_.end(), buffer, buffer + sizeof(buffer));
+            ensure(sizeof(value));
+            memcpy(cur_, &value, sizeof(value));
+            cur_ += sizeof(value);
         }
 
-        void write(bool value) noexcept {
+        bin_write_inline void write(bool value) noexcept {
             write(static_cast<uint8_t>(value));
         }
 
-        [[nodiscard]] bool write(Type type) noexcept {
+        [[nodiscard]] bin_write_inline bool write(Type type) noexcept {
             uint8_t raw = 0;
             if (compat_->type_to_raw(type, raw)) {
                 write(raw);
@@ -58,35 +277,93 @@ namespace ritobin::io::impl_binary_write {
             }
         }
 
+        void write(std::span<char const> value) noexcept {
+            ensure(value.size());
+            memcpy(cur_, value.data(), value.size());
+            cur_ += value.size();
+        }
+
         void write(std::string const& value) noexcept {
             write(static_cast<uint16_t>(value.size()));
-            buffer_.insert(buffer_.end(), value.data(), value.data() + value.size());
+            ensure(value.size());
+            memcpy(cur_, value.data(), value.size());
+            cur_ += value.size();
         }
 
-        void write(FNV1a const& value) noexcept {
+        bin_write_inline void write(FNV1a const& value) noexcept {
             write(value.hash());
         }
 
-        void write(XXH64 const& value) noexcept {
+        bin_write_inline void write(XXH64 const& value) noexcept {
             write(value.hash());
         }
 
         inline size_t position() const noexcept {
-            return buffer_.size();
+            return flushed_ + (cur_ - beg_);
+        }
+
+        // Bytes written from offset on that haven't been flushed yet, only valid until next reserve
+        inline std::span<char const> written_since(size_t offset) const noexcept {
+            return { beg_ + (offset - flushed_), cur_ };
+        }
+
+        // Unless lengths are patched whatever reserve was given has to cover every write
+        bin_write_inline void ensure(size_t size) noexcept {
+            if (static_cast<size_t>(cap_ - cur_) < size) [[unlikely]] {
+                grow(size);
+            }
+        }
+
+        void grow(size_t size) noexcept {
+            assert(patch_lengths_ && vector_ && !file_);
+            // vector still reallocates geometrically, growing its size in small steps only keeps
+            // zeroing of new bytes in cache right before they get overwritten
+            constexpr size_t step = 64 * 1024;
+            auto const used = static_cast<size_t>(cur_ - beg_);
+            vector_->resize(used + std::max(size, step));
+            beg_ = vector_->data();
+            cur_ = beg_ + used;
+            cap_ = beg_ + vector_->size();
         }
     };
 
+    template<typename Compat>
     struct BinBinaryWriter {
-        BinaryWriter writer;
+        BinaryWriter<Compat> writer;
         std::vector<std::string> error;
+        BinSource const* source = nullptr;
+        size_t threads = 1;
 
         bool process(Bin const& bin) noexcept {
             error.clear();
-            writer.buffer_.clear();
             bin_assert(write_sections(bin));
             return true;
         }
 
+        // Same checks as writing sections but only sums up sizes, values themselves are checked once written
+        bool process_size(Bin const& bin, size_t& size) noexcept {
+            error.clear();
+            bin_assert(size_sections(bin, size));
+            return true;
+        }
+
+        bool process_entry(Value const& entryKey, Value const& entryValue) noexcept {
+            auto key = std::get_if<Hash>(&entryKey);
+            auto value = std::get_if<Embed>(&entryValue);
+            bin_assert(key);
+            bin_assert(value);
+            bin_assert(write_entry(*key, *value));
+            return true;
+        }
+
+        // Type byte followed by value, same as field value
+        bool process_value(Value const& value) noexcept {
+            bin_assert(writer.reserve_value(value));
+            bin_assert(writer.write(ValueHelper::value_to_type(value)));
+            bin_assert(write_value(value));
+            return true;
+        }
+
     private:
         bool fail_msg(char const* msg) noexcept {
             error.emplace_back(msg);
@@ -99,6 +376,7 @@ namespace ritobin::io::impl_binary_write {
             auto type = std::get_if<String>(&type_section->second);
             bin_assert(type);
             bin_assert(type->value == "PROP" || type->value == "PTCH");
+            bin_assert(writer.reserve(type->value == "PTCH" ? sizeof(uint32_t) * 5 : sizeof(uint32_t) * 2));
             if (type->value == "PTCH") {
                 writer.write(std::array{ 'P', 'T', 'C', 'H' });
                 writer.write(uint32_t{ 1 });
@@ -124,8 +402,95 @@ namespace ritobin::io::impl_binary_write {
             return true;
         }
 
+        bool size_sections(Bin const& bin, size_t& size) noexcept {
+            auto type_section = bin.sections.find("type");
+            bin_assert(type_section != bin.sections.end());
+            auto type = std::get_if<String>(&type_section->second);
+            bin_assert(type);
+            bin_assert(type->value == "PROP" || type->value == "PTCH");
+            size = type->value == "PTCH" ? sizeof(uint32_t) * 4 : sizeof(uint32_t);
+
+            auto version_section = bin.sections.find("version");
+            bin_assert(version_section != bin.sections.end());
+            auto version = std::get_if<U32>(&version_section->second);
+            bin_assert(version);
+            size += sizeof(uint32_t);
+
+            if (version->value >= 2) {
+                bin_assert(size_links(bin, size));
+            }
+            bin_assert(size_entries(bin, size));
+            if (version->value >= 3 && type->value == "PTCH") {
+                bin_assert(size_patches(bin, size));
+            }
+            return true;
+        }
+
+        bool size_links(Bin const& bin, size_t& size) noexcept {
+            auto linked_section = bin.sections.find("linked");
+            size += sizeof(uint32_t);
+            if (linked_section == bin.sections.end()) {
+                return true;
+            }
+            auto linked = std::get_if<List>(&linked_section->second);
+            bin_assert(linked);
+            bin_assert(linked->valueType == Type::STRING);
+            for (auto const& [item] : linked->items) {
+                auto link = std::get_if<String>(&item);
+                bin_assert(link);
+                size += sizeof(uint16_t) + link->value.size();
+            }
+            return true;
+        }
+
+        bool size_entries(Bin const& bin, size_t& size) noexcept {
+            auto entries_section = bin.sections.find("entries");
+            size += sizeof(uint32_t);
+            if (entries_section == bin.sections.end()) {
+                return true;
+            }
+            auto entries = std::get_if<Map>(&entries_section->second);
+            bin_assert(entries);
+            bin_assert(entries->keyType == Type::HASH);
+            bin_assert(entries->valueType == Type::EMBED);
+            for (auto const& [entryKey, entryValue] : entries->items) {
+                auto key = std::get_if<Hash>(&entryKey);
+                auto value = std::get_if<Embed>(&entryValue);
+                bin_assert(key);
+                bin_assert(value);
+                size += sizeof(uint32_t) + writer.sizer().entry(*value);
+            }
+            return true;
+        }
+
+        bool size_patches(Bin const& bin, size_t& size) noexcept {
+            auto patches_section = bin.sections.find("patches");
+            size += sizeof(uint32_t);
+            if (patches_section == bin.sections.end()) {
+                return true;
+            }
+            auto patches = std::get_if<Map>(&patches_section->second);
+            bin_assert(patches);
+            bin_assert(patches->keyType == Type::HASH);
+            bin_assert(patches->valueType == Type::EMBED);
+            for (auto const& [entryKey, entryValue] : patches->items) {
+                auto key = std::get_if<Hash>(&entryKey);
+                auto value = std::get_if<Embed>(&entryValue);
+                bin_assert(key);
+                bin_assert(value);
+                auto path = value->find_field({"path"});
+                auto item = value->find_field({"value"});
+                bin_assert(path);
+                bin_assert(item);
+                bin_assert(std::holds_alternative<String>(path->value));
+                size += writer.sizer().patch(*value);
+            }
+            return true;
+        }
+
         bool write_links(Bin const& bin) noexcept {
             auto linked_section = bin.sections.find("linked");
+            bin_assert(writer.reserve(sizeof(uint32_t)));
             if (linked_section == bin.sections.end()) {
                 writer.write(static_cast<uint32_t>(0));
                 return true;
@@ -137,6 +502,7 @@ namespace ritobin::io::impl_binary_write {
             for (auto const& [item] : linked->items) {
                 auto link = std::get_if<String>(&item);
                 bin_assert(link);
+                bin_assert(writer.reserve(sizeof(uint16_t) + link->value.size()));
                 writer.write(link->value);
             }
             return true;
@@ -144,6 +510,7 @@ namespace ritobin::io::impl_binary_write {
     
         bool write_entries(Bin const& bin) noexcept {
             auto entries_section = bin.sections.find("entries");
+            bin_assert(writer.reserve(sizeof(uint32_t)));
             if (entries_section == bin.sections.end()) {
                 writer.write(static_cast<uint32_t>(0));
                 return true;
@@ -155,26 +522,142 @@ namespace ritobin::io::impl_binary_write {
 
             writer.write(static_cast<uint32_t>(entries->items.size()));
 
-            std::vector<uint32_t> entryNameHashes;
+            // name table is filled in as entries are written so entries are only walked once,
+            // streamed output might be flushed before that and parallel output is written in chunks so there it's written upfront
+            bin_assert(writer.reserve(sizeof(uint32_t) * entries->items.size()));
             size_t entryNameHashes_offset = writer.position();
-            writer.skip(sizeof(uint32_t) * entries->items.size());
-            entryNameHashes.reserve(entries->items.size());
+            auto const parallel = threads > 1 && entries->items.size() > 1;
+            auto const upfront = writer.file_ != nullptr || parallel;
+            if (upfront) {
+                for (auto const& [entryKey, entryValue] : entries->items) {
+                    // entry that isn't embed fails once it's written so error is reported in same order
+                    auto value = std::get_if<Embed>(&entryValue);
+                    writer.write(value ? value->name.hash() : uint32_t{});
+                }
+            } else {
+                writer.skip(sizeof(uint32_t) * entries->items.size());
+            }
+            // failing chunk already carries same frames sequential writing would add
+            if (parallel) {
+                return write_entries_parallel(entries->items);
+            }
 
+            // raw type bytes differ between compats so source can only be copied into same one
+            auto const clean_source = source && source->compat == writer.compat_ ? source : nullptr;
             for (auto const& [entryKey, entryValue] : entries->items) {
                 auto key = std::get_if<Hash>(&entryKey);
                 auto value = std::get_if<Embed>(&entryValue);
                 bin_assert(key);
                 bin_assert(value);
-                entryNameHashes.push_back(value->name.hash());
+                if (!upfront) {
+                    writer.write_at(entryNameHashes_offset, value->name.hash());
+                    entryNameHashes_offset += sizeof(uint32_t);
+                }
+                if (clean_source) {
+                    if (auto clean = clean_source->find_clean(key->value); clean && clean->name == value->name.hash()) {
+                        if (clean_source->checked) {
+                            auto const entry_start = writer.position();
+                            bin_assert(write_entry(*key, *value));
+                            bin_assert(std::ranges::equal(writer.written_since(entry_start), clean->data));
+                            continue;
+                        }
+                        bin_assert(writer.reserve(clean->data.size()));
+                        writer.write(clean->data);
+                        continue;
+                    }
+                }
                 bin_assert(write_entry(*key, *value));
             }
-            writer.write(entryNameHashes, entryNameHashes_offset);
             return true;
         }
 
+        // Chunks of entries are sized first so each one can be encoded straight into its place in output,
+        // output that gets flushed takes only as many chunks at once as fit into its buffer.
+        // Error from first failing chunk is reported so trace matches sequential writing.
+        bool write_entries_parallel(PairList const& items) noexcept {
+            constexpr size_t chunk = 64;
+            auto const chunks = (items.size() + chunk - 1) / chunk;
+            std::vector<size_t> chunk_sizes(chunks);
+            run_chunks(0, chunks, [&](size_t c) {
+                std::vector<uint32_t> sizes;
+                BinarySizer sizer = { sizes };
+                auto const end = std::min((c + 1) * chunk, items.size());
+                for (size_t i = c * chunk; i != end; i++) {
+                    // entry that isn't embed fails once it's encoded
+                    if (auto value = std::get_if<Embed>(&items[i].value)) {
+                        sizes.clear();
+                        chunk_sizes[c] += sizer.entry(*value);
+                    }
+                }
+                return true;
+            });
+
+            auto const window_limit = writer.file_ ? static_cast<size_t>(writer.cap_ - writer.beg_) : SIZE_MAX;
+            std::vector<char*> chunk_starts(chunks);
+            std::vector<std::vector<std::string>> chunk_errors(chunks);
+            for (size_t first = 0, last = 0; first != chunks; first = last) {
+                size_t window = chunk_sizes[last++];
+                while (last != chunks && window + chunk_sizes[last] <= window_limit) {
+                    window += chunk_sizes[last++];
+                }
+                bin_assert(writer.reserve(window));
+                for (size_t c = first, offset = 0; c != last; offset += chunk_sizes[c++]) {
+                    chunk_starts[c] = writer.cur_ + offset;
+                }
+                auto const failed = run_chunks(first, last, [&](size_t c) {
+                    auto const start = chunk_starts[c];
+                    BinBinaryWriter chunkWriter = { { writer.compat_, nullptr, nullptr, start, start, start + chunk_sizes[c] }, {} };
+                    auto const end = std::min((c + 1) * chunk, items.size());
+                    for (size_t i = c * chunk; i != end; i++) {
+                        if (!chunkWriter.process_entry(items[i].key, items[i].value)) {
+                            chunk_errors[c] = std::move(chunkWriter.error);
+                            return false;
+                        }
+                    }
+                    return true;
+                });
+                if (failed != last) {
+                    error.insert(error.end(), chunk_errors[failed].begin(), chunk_errors[failed].end());
+                    return false;
+                }
+                writer.skip(window);
+            }
+            return true;
+        }
+
+        // Calls work for each chunk in range on up to threads threads, no chunk past one that failed is started.
+        // Returns first chunk work failed on or last when all of them succeeded.
+        template<typename F>
+        size_t run_chunks(size_t first, size_t last, F&& work) noexcept {
+            auto const workers = std::min(threads, last - first);
+            std::atomic<size_t> next = first;
+            std::atomic<size_t> failed = last;
+            std::mutex failed_lock;
+            auto worker = [&] {
+                for (size_t c = next++; c < last && c < failed; c = next++) {
+                    if (!work(c)) {
+                        std::lock_guard guard(failed_lock);
+                        if (c < failed) {
+                            failed = c;
+                        }
+                        return;
+                    }
+                }
+            };
+            std::vector<std::thread> pool;
+            for (size_t i = 1; i < workers; i++) {
+                pool.emplace_back(worker);
+            }
+            worker();
+            for (auto& thread : pool) {
+                thread.join();
+            }
+            return failed;
+        }
+
         bool write_entry(Hash const& entryKey, Embed const& entryValue) noexcept {
-            size_t position = writer.position();
-            writer.write(uint32_t{});
+            bin_assert(writer.reserve_entry(entryValue));
+            auto const length = writer.write_length();
             writer.write(uint32_t{ entryKey.value.hash() });
             writer.write(static_cast<uint16_t>(entryValue.items.size()));
             for (auto const& [name, item] : entryValue.items) {
@@ -182,13 +665,14 @@ namespace ritobin::io::impl_binary_write {
                 bin_assert(writer.write(ValueHelper::value_to_type(item)));
                 bin_assert(write_value(item));
             }
-            writer.write_at(position, writer.position() - position - 4);
+            writer.end_length(length);
             return true;
         }
 
 
         bool write_patches(Bin const& bin) noexcept {
             auto patches_section = bin.sections.find("patches");
+            bin_assert(writer.reserve(sizeof(uint32_t)));
             if (patches_section == bin.sections.end()) {
                 writer.write(static_cast<uint32_t>(0));
                 return true;
@@ -209,9 +693,8 @@ namespace ritobin::io::impl_binary_write {
         }
 
         bool write_patch(Hash const& patchKey, Embed const& patchValue) noexcept {
+            bin_assert(writer.reserve_patch(patchValue));
             writer.write(uint32_t{ patchKey.value.hash() });
-            size_t position = writer.position();
-            writer.write(uint32_t{});
             auto const name = patchValue.find_field({"path"});
             auto const value = patchValue.find_field({"value"});
             bin_assert(name);
@@ -219,24 +702,24 @@ namespace ritobin::io::impl_binary_write {
             auto const nameType = ValueHelper::value_to_type(name->value);
             auto const valueType = ValueHelper::value_to_type(value->value);
             bin_assert(nameType == Type::STRING);
+            auto const length = writer.write_length();
             bin_assert(writer.write(valueType));
             writer.write(std::get<String>(name->value).value);
             write_value(value->value);
-            writer.write_at(position, writer.position() - position - 4);
+            writer.end_length(length);
             return true;
         }
 
         bool write_value_visit(Embed const& value) noexcept {
             writer.write(value.name);
-            size_t position = writer.position();
-            writer.write(uint32_t{ 0 });
+            auto const length = writer.write_length();
             writer.write(static_cast<uint16_t>(value.items.size()));
             for (auto const& [name, item] : value.items) {
                 writer.write(name.hash());
                 bin_assert(writer.write(ValueHelper::value_to_type(item)));
                 bin_assert(write_value(item));
             }
-            writer.write_at(position, writer.position() - position - 4);
+            writer.end_length(length);
             return true;
         }
 
@@ -245,41 +728,38 @@ namespace ritobin::io::impl_binary_write {
             if (value.name.hash() == 0) {
                 return true;
             }
-            size_t position = writer.position();
-            writer.write(uint32_t{ 0 });
+            auto const length = writer.write_length();
             writer.write(static_cast<uint16_t>(value.items.size()));
             for (auto const& [name, item] : value.items) {
                 writer.write(name.hash());
                 bin_assert(writer.write(ValueHelper::value_to_type(item)));
                 bin_assert(write_value(item));
             }
-            writer.write_at(position, writer.position() - position - 4);
+            writer.end_length(length);
             return true;
         }
 
         bool write_value_visit(List const& value) noexcept {
             bin_assert(!ValueHelper::is_container(value.valueType));
             bin_assert(writer.write(value.valueType));
-            size_t position = writer.position();
-            writer.write(uint32_t{ 0 });
+            auto const length = writer.write_length();
             writer.write(static_cast<uint32_t>(value.items.size()));
             for (auto const& [item] : value.items) {
                 bin_assert(write_value(item, value.valueType));
             }
-            writer.write_at(position, writer.position() - position - 4);
+            writer.end_length(length);
             return true;
         }
 
         bool write_value_visit(List2 const& value) noexcept {
             bin_assert(!ValueHelper::is_container(value.valueType));
             bin_assert(writer.write(value.valueType));
-            size_t position = writer.position();
-            writer.write(uint32_t{ 0 });
+            auto const length = writer.write_length();
             writer.write(static_cast<uint32_t>(value.items.size()));
             for (auto const& [item] : value.items) {
                 bin_assert(write_value(item, value.valueType));
             }
-            writer.write_at(position, writer.position() - position - 4);
+            writer.end_length(length);
             return true;
         }
 
@@ -288,14 +768,13 @@ namespace ritobin::io::impl_binary_write {
             bin_assert(!ValueHelper::is_container(value.valueType));
             bin_assert(writer.write(value.keyType));
             bin_assert(writer.write(value.valueType));
-            size_t position = writer.position();
-            writer.write(uint32_t{ 0 });
+            auto const length = writer.write_length();
             writer.write(static_cast<uint32_t>(value.items.size()));
             for (auto const& [key, item] : value.items) {
                 bin_assert(write_value(key, value.keyType));
                 bin_assert(write_value(item, value.valueType));
             }
-            writer.write_at(position, writer.position() - position - 4);
+            writer.end_length(length);
             return true;
         }
 
@@ -341,14 +820,293 @@ namespace ritobin::io::impl_binary_write {
             return trace;
         }
     };
+
+    // Finds field in encoded .bin with bounds checked skips and splices new value over it,
+    // offsets of all length prefixes enclosing the field are kept so they can be fixed up
+    struct BinBinaryPatcher {
+        std::vector<char>& data;
+        BinCompat const* compat;
+        size_t cur = 0;
+        std::vector<size_t> lengths = {};
+
+        bool index_entries(std::vector<size_t>& offsets, std::unordered_map<uint32_t, size_t>& by_key) noexcept {
+            std::array<char, 4> magic = {};
+            uint32_t version = {};
+            if (!read(magic)) {
+                return false;
+            }
+            if (magic == std::array{ 'P', 'T', 'C', 'H' }) {
+                if (!skip(sizeof(uint64_t)) || !read(magic)) {
+                    return false;
+                }
+            }
+            if (magic != std::array{ 'P', 'R', 'O', 'P' } || !read(version)) {
+                return false;
+            }
+            if (version >= 2) {
+                uint32_t linkedCount = {};
+                if (!read(linkedCount)) {
+                    return false;
+                }
+                for (uint32_t i = 0; i != linkedCount; i++) {
+                    if (!skip_value(Type::STRING)) {
+                        return false;
+                    }
+                }
+            }
+            uint32_t entryCount = {};
+            if (!read(entryCount) || !skip(sizeof(uint32_t) * static_cast<size_t>(entryCount))) {
+                return false;
+            }
+            offsets.reserve(entryCount);
+            for (uint32_t i = 0; i != entryCount; i++) {
+                auto const start = cur;
+                uint32_t entryLength = {};
+                uint32_t entryKey = {};
+                if (!read(entryLength) || entryLength < sizeof(uint32_t) || !read(entryKey)) {
+                    return false;
+                }
+                if (!skip(entryLength - sizeof(uint32_t))) {
+                    return false;
+                }
+                by_key.emplace(entryKey, offsets.size());
+                offsets.push_back(start);
+            }
+            return true;
+        }
+
+        std::string patch_entry(size_t entry, std::span<FNV1a const> path, Value const& value, int64_t& delta) noexcept {
+            if (path.empty()) {
+                return "Empty field path!";
+            }
+            cur = entry;
+            lengths.push_back(entry);
+            uint16_t count = {};
+            if (!skip(sizeof(uint32_t) * 2) || !read(count)) {
+                return "Failed to read entry!";
+            }
+            Type type = {};
+            for (size_t i = 0; i != path.size(); i++) {
+                if (!find_field(path[i].hash(), count, type)) {
+                    return "Field not found!";
+                }
+                if (i + 1 == path.size()) {
+                    break;
+                }
+                uint32_t name = {};
+                if ((type != Type::EMBED && type != Type::POINTER) || !read(name)) {
+                    return "Field is not embed or pointer!";
+                }
+                if (name == 0 && type == Type::POINTER) {
+                    return "Field is null pointer!";
+                }
+                lengths.push_back(cur);
+                if (!skip(sizeof(uint32_t)) || !read(count)) {
+                    return "Failed to read field!";
+                }
+            }
+
+            auto const start = cur - sizeof(uint8_t);
+            if (!skip_value(type)) {
+                return "Failed to read field!";
+            }
+            auto const old_size = cur - start;
+
+            std::vector<char> encoded;
+            BinBinaryWriter<BinCompat> writer = { { compat, &encoded }, {} };
+            auto const ok = writer.process_value(value);
+            (void)writer.writer.finish();
+            if (!ok) {
+                return writer.trace_error();
+            }
+
+            delta = static_cast<int64_t>(encoded.size()) - static_cast<int64_t>(old_size);
+            for (auto offset : lengths) {
+                uint32_t length = {};
+                memcpy(&length, data.data() + offset, sizeof(uint32_t));
+                auto const fixed = static_cast<int64_t>(length) + delta;
+                if (fixed < 0 || fixed > UINT32_MAX) {
+                    return "Length prefix overflow!";
+                }
+                length = static_cast<uint32_t>(fixed);
+                memcpy(data.data() + offset, &length, sizeof(uint32_t));
+            }
+            if (encoded.size() > old_size) {
+                data.insert(data.begin() + start + old_size, encoded.size() - old_size, '\0');
+            } else if (encoded.size() < old_size) {
+                data.erase(data.begin() + start + encoded.size(), data.begin() + start + old_size);
+            }
+            memcpy(data.data() + start, encoded.data(), encoded.size());
+            return {};
+        }
+
+    private:
+        template<typename T>
+        bool read(T& value) noexcept {
+            if (data.size() - cur < sizeof(T)) {
+                return false;
+            }
+            memcpy(&value, data.data() + cur, sizeof(T));
+            cur += sizeof(T);
+            return true;
+        }
+
+        bool read(Type& type) noexcept {
+            uint8_t raw = {};
+            return read(raw) && compat->raw_to_type(raw, type);
+        }
+
+        bool skip(size_t size) noexcept {
+            if (data.size() - cur < size) {
+                return false;
+            }
+            cur += size;
+            return true;
+        }
+
+        bool skip_value(Type type) noexcept {
+            auto const begin = data.data();
+            auto const value_end = impl_binary_skip::skip_value(type, begin + cur, begin + data.size(), compat);
+            if (!value_end) {
+                return false;
+            }
+            cur = static_cast<size_t>(value_end - begin);
+            return true;
+        }
+
+        bool find_field(uint32_t name, uint16_t count, Type& type) noexcept {
+            for (uint16_t i = 0; i != count; i++) {
+                uint32_t fieldName = {};
+                if (!read(fieldName) || !read(type)) {
+                    return false;
+                }
+                if (fieldName == name) {
+                    return true;
+                }
+                if (!skip_value(type)) {
+                    return false;
+                }
+            }
+            return false;
+        }
+    };
+}
+
+namespace ritobin::io::impl_binary_write {
+    using compat_impl::visit_compat;
+
+    static size_t resolve_threads(size_t threads) noexcept {
+        return threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    static std::string write_binary_vector(Bin const& bin, std::vector<char>& out, BinCompat const* compat,
+                                           BinSource const* source, size_t threads) noexcept {
+        out.clear();
+        return visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            BinBinaryWriter<Compat> writer = { { compat, &out }, {}, source, threads };
+            // Parallel entries are written in place so only sequential output can skip sizing
+            writer.writer.patch_lengths_ = threads <= 1;
+            auto const ok = writer.process(bin);
+            (void)writer.writer.finish();
+            if (!ok) {
+                return writer.trace_error();
+            }
+            return {};
+        });
+    }
 }
 
 namespace ritobin::io {
     using namespace impl_binary_write;
 
     std::string write_binary(Bin const& bin, std::vector<char>& out, BinCompat const* compat) noexcept {
-        BinBinaryWriter writer = { { out, compat }, {} };
-        if (!writer.process(bin)) {
+        return write_binary_vector(bin, out, compat, nullptr, 1);
+    }
+
+    std::string write_binary(Bin const& bin, std::vector<char>& out, BinCompat const* compat, BinSource const& source) noexcept {
+        return write_binary_vector(bin, out, compat, &source, 1);
+    }
+
+    std::string write_binary(Bin const& bin, std::vector<char>& out, BinCompat const* compat, size_t threads) noexcept {
+        return write_binary_vector(bin, out, compat, nullptr, resolve_threads(threads));
+    }
+
+    std::string write_binary(Bin const& bin, std::FILE* file, BinCompat const* compat) noexcept {
+        return write_binary(bin, file, compat, 1);
+    }
+
+    std::string write_binary(Bin const& bin, std::FILE* file, BinCompat const* compat, size_t threads) noexcept {
+        std::vector<char> buffer(1024 * 1024);
+        return visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            BinBinaryWriter<Compat> writer = { { compat, &buffer, file, buffer.data(), buffer.data(), buffer.data() + buffer.size() },
+                                               {}, nullptr, resolve_threads(threads) };
+            if (!writer.process(bin)) {
+                return writer.trace_error();
+            }
+            if (!writer.writer.finish()) {
+                return "Failed to write file!";
+            }
+            return {};
+        });
+    }
+
+    std::string write_binary(Bin const& bin, std::span<char> out, BinCompat const* compat) noexcept {
+        return write_binary(bin, out, compat, 1);
+    }
+
+    std::string write_binary(Bin const& bin, std::span<char> out, BinCompat const* compat, size_t threads) noexcept {
+        return visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            BinBinaryWriter<Compat> writer = { { compat, nullptr, nullptr, out.data(), out.data(), out.data() + out.size() },
+                                               {}, nullptr, resolve_threads(threads) };
+            if (!writer.process(bin)) {
+                return writer.trace_error();
+            }
+            if (writer.writer.position() != out.size()) {
+                return "Output size doesn't match size_binary!";
+            }
+            return {};
+        });
+    }
+
+    std::string BinPatcher::open(std::vector<char>& data, BinCompat const* compat) noexcept {
+        data_ = &data;
+        compat_ = compat;
+        offsets_.clear();
+        by_key_.clear();
+        BinBinaryPatcher patcher = { data, compat };
+        if (!patcher.index_entries(offsets_, by_key_)) {
+            data_ = nullptr;
+            return "Failed to index entries!";
+        }
+        return {};
+    }
+
+    std::string BinPatcher::set(FNV1a const& entry, std::span<FNV1a const> path, Value const& value) noexcept {
+        if (!data_) {
+            return "Patcher is not open!";
+        }
+        auto const index = by_key_.find(entry.hash());
+        if (index == by_key_.end()) {
+            return "Entry not found!";
+        }
+        int64_t delta = 0;
+        BinBinaryPatcher patcher = { *data_, compat_ };
+        if (auto error = patcher.patch_entry(offsets_[index->second], path, value, delta); !error.empty()) {
+            return error;
+        }
+        if (delta != 0) {
+            for (size_t i = index->second + 1; i != offsets_.size(); i++) {
+                offsets_[i] = static_cast<size_t>(static_cast<int64_t>(offsets_[i]) + delta);
+            }
+        }
+        return {};
+    }
+
+    std::string size_binary(Bin const& bin, size_t& size) noexcept {
+        size = 0;
+        // sizes don't depend on compat
+        BinBinaryWriter<BinCompat> writer = { { nullptr }, {} };
+        if (!writer.process_size(bin, size)) {
             return writer.trace_error();
         }
         return {};
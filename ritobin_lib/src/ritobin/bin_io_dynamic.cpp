@@ -1,54 +1,10 @@
 #include "bin_io.hpp"
 #include "bin_types_helper.hpp"
+#include "bin_io_binary_compat.hpp"
 
 namespace ritobin::io::compat_impl {
-    static struct BinCompatLatest : BinCompat {
-        char const* name() const noexcept override {
-            return "bin";
-        }
-        bool type_to_raw(Type type, uint8_t &raw) const noexcept override {
-            raw = static_cast<uint8_t>(type);
-            return true;
-        }
-        bool raw_to_type(uint8_t raw, Type &type) const noexcept override {
-            type = static_cast<Type>(raw);
-            if (ValueHelper::is_primitive(type)) {
-                if (type <= ValueHelper::MAX_PRIMITIVE) {
-                    return true;
-                } else {
-                    return false;
-                }
-            } else {
-                if (type <= ValueHelper::MAX_COMPLEX) {
-                    return true;
-                } else {
-                    return false;
-                }
-            }
-        }
-    } compat_bin_latest = {};
-
-    static struct BinCompatLegacy : BinCompat {
-        char const* name() const noexcept override {
-            return "bin-legacy1";
-        }
-        bool type_to_raw(Type type, uint8_t &raw) const noexcept override {
-            if (type == Type::LIST2) {
-                type = Type::LIST;
-            }
-            return compat_bin_latest.type_to_raw(type, raw);
-        }
-        bool raw_to_type(uint8_t raw, Type& type) const noexcept override {
-            if (raw >= 18 && raw < 0x80) {
-                raw -= 18;
-                raw |= 0x80;
-            }
-            if (raw >= 0x81) {
-                raw += 1;
-            }
-            return compat_bin_latest.raw_to_type(raw, type);
-        }
-    } compat_bin_legacy1 = {};
+    BinCompatLatest const compat_bin_latest = {};
+    BinCompatLegacy1 const compat_bin_legacy1 = {};
 
     static BinCompat const* bin_versions[] = {
         &compat_bin_latest,
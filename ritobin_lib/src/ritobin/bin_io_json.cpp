@@ -2,6 +2,8 @@
 #include "bin_types.hpp"
 #include "bin_types_helper.hpp"
 #include "bin_numconv.hpp"
+#include "bin_io_binary_read.hpp"
+#include "bin_unhash.hpp"
 #define JSON_NOEXCEPTION
 #include <json.hpp>
 #include <optional>
@@ -60,6 +62,29 @@ namespace ritobin::io::json_impl {
         return "[" + std::to_string(index) + "]";
     }
 
+    // Float widened to double prints all of its noise digits (0.1 becomes 0.10000000149011612),
+    // go through shortest float text so json gets double that prints as short as float does in text.
+    // Few floats don't survive rounding twice when read back as double then float, those stay widened.
+    template<typename T>
+    static void number_to_json(T const& value, json& json) noexcept {
+        if constexpr (std::is_same_v<T, float>) {
+            char buffer[64];
+            double result = value;
+            if (!to_num({ buffer, from_num(buffer, buffer + sizeof(buffer), value) }, result)
+                || static_cast<float>(result) != value) {
+                result = value;
+            }
+            json = result;
+        } else if constexpr (requires { value.size(); }) {
+            json = json::array();
+            for (auto const& item: value) {
+                number_to_json(item, json.emplace_back());
+            }
+        } else {
+            json = value;
+        }
+    }
+
     template<typename T>
     static void hash_to_json(T const& value, json& json) noexcept {
         if (value.str().empty()) {
@@ -161,11 +186,11 @@ namespace ritobin::io::json_impl {
         static constexpr char const * type_name = T::type_name;
 
         static void to_json(T const& value, json& json) noexcept {
-            json = value.value;
+            number_to_json(value.value, json);
         }
 
         static void to_json_info(T const& value, json& json) noexcept {
-            json = value.value;
+            number_to_json(value.value, json);
         }
 
         static ErrorStackOption from_json(T& value, json const& json) noexcept {
@@ -185,11 +210,11 @@ namespace ritobin::io::json_impl {
         static constexpr char const * type_name = T::type_name;
 
         static void to_json(T const& value, json& json) noexcept {
-            json = value.value;
+            number_to_json(value.value, json);
         }
 
         static void to_json_info(T const& value, json& json) noexcept {
-            json = value.value;
+            number_to_json(value.value, json);
         }
 
         static ErrorStackOption from_json(T& value, json const& json) noexcept {
@@ -489,6 +514,392 @@ namespace ritobin::io::json_impl {
     }
 }
 
+namespace ritobin::io::json_impl {
+    // Writes same json as bin_to_json straight from walker events so Bin never has to be built
+    // Keys are written in same sorted order json objects keep them in, only sections need to be held back for that
+    struct BinJsonVisitor {
+        struct Frame {
+            Type type;
+            Type keyType = {};
+            Type valueType = {};
+            uint32_t name = {};
+            bool patch = {};
+            bool key = true;
+        };
+
+        // Same depth limit as BinUnhasher::unhash_bin, value at depth of open containers is unhashed
+        static constexpr size_t max_depth = 100;
+
+        std::vector<char>& out;
+        BinUnhasher const* unhasher;
+        // When set out is only a buffer that gets flushed to file between entries
+        std::FILE* file = {};
+        bool failed = {};
+        bool pretty;
+        unsigned indent_size;
+        nlohmann::detail::serializer<json> serializer;
+        std::vector<bool> scopes = {};
+        std::vector<Frame> frames = {};
+        std::string type = {};
+        uint32_t version = {};
+        bool has_linked = {};
+        std::vector<std::string> linked_paths = {};
+
+        BinJsonVisitor(std::vector<char>& out, BinUnhasher const* unhasher, int indent_size) noexcept
+            : out(out)
+            , unhasher(unhasher)
+            , pretty(indent_size >= 0)
+            , indent_size(indent_size >= 0 ? static_cast<unsigned>(indent_size) : 0)
+            , serializer(nlohmann::detail::output_adapter<char>(out), ' ') {}
+
+        bool header(std::string_view type, uint32_t version) noexcept {
+            this->type = type;
+            this->version = version;
+            has_linked = version >= 2;
+            open('{');
+            return true;
+        }
+
+        bool linked(std::string_view path) noexcept {
+            linked_paths.emplace_back(path);
+            return true;
+        }
+
+        bool begin_entries(uint32_t) noexcept {
+            begin_section("entries", Type::MAP);
+            begin_items({ Type::MAP, Type::HASH, Type::EMBED });
+            return true;
+        }
+
+        bool end_entries() noexcept {
+            end_items();
+            if (has_linked) {
+                begin_section("linked", Type::LIST);
+                begin_items({ Type::LIST, {}, Type::STRING });
+                for (auto const& path : linked_paths) {
+                    separate();
+                    scalar(path);
+                }
+                end_items();
+            }
+            return true;
+        }
+
+        bool begin_entry(uint32_t key, uint32_t name, uint16_t) noexcept {
+            begin_value();
+            write_hash(key, frames.size());
+            end_value();
+            begin_value();
+            begin_items({ Type::EMBED, {}, {}, name });
+            return true;
+        }
+
+        bool end_entry() noexcept {
+            end_items();
+            flush(false);
+            return true;
+        }
+
+        bool begin_patches(uint32_t) noexcept {
+            begin_section("patches", Type::MAP);
+            begin_items({ Type::MAP, Type::HASH, Type::EMBED });
+            return true;
+        }
+
+        bool end_patches() noexcept {
+            end_items();
+            return true;
+        }
+
+        bool begin_patch(uint32_t key, std::string_view path, Type type) noexcept {
+            begin_value();
+            write_hash(key, frames.size());
+            end_value();
+            begin_value();
+            begin_items({ Type::EMBED, {}, {}, {}, true });
+            begin_field("path", Type::STRING);
+            scalar(std::string(path));
+            end_value();
+            begin_field("value", type);
+            return true;
+        }
+
+        bool end_patch() noexcept {
+            end_items();
+            flush(false);
+            return true;
+        }
+
+        bool field(uint32_t key, Type type) noexcept {
+            separate();
+            open('{');
+            write_key("key");
+            // field names belong to class one level up
+            write_hash(key, frames.size() - 1);
+            write_key("type");
+            scalar(ValueHelper::type_to_type_name(type));
+            write_key("value");
+            return true;
+        }
+
+        bool value(ValueView const& value) noexcept {
+            begin_value();
+            switch (value.type) {
+            case Type::BOOL: write_view<Bool>(value); break;
+            case Type::I8: write_view<I8>(value); break;
+            case Type::U8: write_view<U8>(value); break;
+            case Type::I16: write_view<I16>(value); break;
+            case Type::U16: write_view<U16>(value); break;
+            case Type::I32: write_view<I32>(value); break;
+            case Type::U32: write_view<U32>(value); break;
+            case Type::I64: write_view<I64>(value); break;
+            case Type::U64: write_view<U64>(value); break;
+            case Type::F32: write_view<F32>(value); break;
+            case Type::VEC2: write_view<Vec2>(value); break;
+            case Type::VEC3: write_view<Vec3>(value); break;
+            case Type::VEC4: write_view<Vec4>(value); break;
+            case Type::MTX44: write_view<Mtx44>(value); break;
+            case Type::RGBA: write_view<RGBA>(value); break;
+            case Type::STRING: write_view<String>(value); break;
+            case Type::FLAG: write_view<Flag>(value); break;
+            case Type::HASH:
+            case Type::LINK: {
+                uint32_t hash = {};
+                memcpy(&hash, value.data, sizeof(hash));
+                write_hash(hash, frames.size());
+                break;
+            }
+            case Type::FILE: {
+                uint64_t hash = {};
+                memcpy(&hash, value.data, sizeof(hash));
+                write_hash(hash, frames.size());
+                break;
+            }
+            default:
+                break;
+            }
+            end_value();
+            return true;
+        }
+
+        bool begin_class(Type, uint32_t name, uint16_t) noexcept {
+            begin_value();
+            begin_items({ Type::EMBED, {}, {}, name });
+            return true;
+        }
+
+        bool end_class() noexcept {
+            end_items();
+            return true;
+        }
+
+        bool begin_list(Type, Type valueType, uint32_t) noexcept {
+            begin_value();
+            begin_items({ Type::LIST, {}, valueType });
+            return true;
+        }
+
+        bool end_list() noexcept {
+            end_items();
+            return true;
+        }
+
+        bool begin_map(Type keyType, Type valueType, uint32_t) noexcept {
+            begin_value();
+            begin_items({ Type::MAP, keyType, valueType });
+            return true;
+        }
+
+        bool end_map() noexcept {
+            end_items();
+            return true;
+        }
+
+        void finish() noexcept {
+            begin_section("type", Type::STRING);
+            scalar(type);
+            end_value();
+            begin_section("version", Type::U32);
+            scalar(version);
+            end_value();
+            close('}');
+            flush(true);
+        }
+    private:
+        // Keys come out in final order so everything written so far can go to file
+        void flush(bool all) noexcept {
+            if (!file || failed || (!all && out.size() < 1024 * 1024)) {
+                return;
+            }
+            failed = fwrite(out.data(), 1, out.size(), file) != out.size() || (all && fflush(file) != 0);
+            out.clear();
+        }
+
+        void newline() noexcept {
+            if (pretty) {
+                out.push_back('\n');
+                out.insert(out.end(), scopes.size() * indent_size, ' ');
+            }
+        }
+
+        void separate() noexcept {
+            if (!scopes.back()) {
+                out.push_back(',');
+            }
+            scopes.back() = false;
+            newline();
+        }
+
+        void open(char c) noexcept {
+            out.push_back(c);
+            scopes.push_back(true);
+        }
+
+        void close(char c) noexcept {
+            auto const empty = scopes.back();
+            scopes.pop_back();
+            if (!empty) {
+                newline();
+            }
+            out.push_back(c);
+        }
+
+        template<size_t S>
+        void write_key(char const(&name)[S]) noexcept {
+            separate();
+            out.push_back('"');
+            out.insert(out.end(), name, name + S - 1);
+            out.push_back('"');
+            out.push_back(':');
+            if (pretty) {
+                out.push_back(' ');
+            }
+        }
+
+        void scalar(json const& value) noexcept {
+            serializer.dump(value, pretty, false, indent_size, static_cast<unsigned>(scopes.size()) * indent_size);
+        }
+
+        template<size_t S>
+        void begin_section(char const(&name)[S], Type type) noexcept {
+            write_key(name);
+            open('{');
+            write_key("type");
+            scalar(ValueHelper::type_to_type_name(type));
+            write_key("value");
+        }
+
+        void begin_field(char const* name, Type type) noexcept {
+            separate();
+            open('{');
+            write_key("key");
+            scalar(name);
+            write_key("type");
+            scalar(ValueHelper::type_to_type_name(type));
+            write_key("value");
+        }
+
+        // Container items are written first as they sort before keyType, name and valueType
+        void begin_items(Frame frame) noexcept {
+            frames.push_back(frame);
+            open('{');
+            write_key("items");
+            open('[');
+        }
+
+        void end_items() noexcept {
+            auto const frame = frames.back();
+            frames.pop_back();
+            close(']');
+            if (frame.type == Type::EMBED) {
+                write_key("name");
+                if (frame.patch) {
+                    scalar("patch");
+                } else {
+                    write_hash(frame.name, frames.size());
+                }
+            } else {
+                if (frame.type == Type::MAP) {
+                    write_key("keyType");
+                    scalar(ValueHelper::type_to_type_name(frame.keyType));
+                }
+                write_key("valueType");
+                scalar(ValueHelper::type_to_type_name(frame.valueType));
+            }
+            close('}');
+            end_value();
+        }
+
+        void begin_value() noexcept {
+            if (frames.empty()) {
+                return;
+            }
+            auto const& frame = frames.back();
+            if (frame.type == Type::LIST) {
+                separate();
+            } else if (frame.type == Type::MAP) {
+                if (frame.key) {
+                    separate();
+                    open('{');
+                    write_key("key");
+                } else {
+                    write_key("value");
+                }
+            }
+        }
+
+        void end_value() noexcept {
+            if (frames.empty()) {
+                close('}');
+                return;
+            }
+            auto& frame = frames.back();
+            if (frame.type == Type::LIST) {
+                return;
+            }
+            if (frame.type == Type::MAP) {
+                frame.key = !frame.key;
+                if (!frame.key) {
+                    return;
+                }
+            }
+            close('}');
+        }
+
+        template<typename T>
+        void write_view(ValueView const& view) noexcept {
+            typename ViewValue<T>::type value = {};
+            (void)view.get<T>(value);
+            if constexpr (std::is_same_v<T, String>) {
+                scalar(std::string(value));
+            } else {
+                json number;
+                number_to_json(value, number);
+                scalar(number);
+            }
+        }
+
+        // Unhasher would replace hash with hash of name even when name is empty
+        void write_hash(uint32_t hash, size_t depth) noexcept {
+            auto name = unhasher && depth < max_depth ? unhasher->find_fnv1a(hash) : nullptr;
+            if (name && !name->empty()) {
+                scalar(*name);
+            } else {
+                scalar(name ? FNV1a(*name).hash() : hash);
+            }
+        }
+
+        void write_hash(uint64_t hash, size_t depth) noexcept {
+            auto name = unhasher && depth < max_depth ? unhasher->find_xxh64(hash) : nullptr;
+            if (name && !name->empty()) {
+                scalar(*name);
+            } else {
+                scalar(name ? XXH64(*name).hash() : hash);
+            }
+        }
+    };
+}
+
 namespace ritobin::io {
     using namespace json_impl;
 
@@ -509,4 +920,37 @@ namespace ritobin::io {
         bin_to_json_info(value, out, indent_size);
         return {};
     }
+
+    std::string write_json(std::span<char const> data, BinCompat const* compat, BinUnhasher const* unhasher,
+                           std::vector<char>& out, int indent_size) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        impl_binary_read::BinBinaryWalker<BinJsonVisitor> walker = {
+            { out, unhasher, indent_size }, { begin, begin, end, compat }, {}
+        };
+        if (!walker.process()) {
+            return walker.trace_error();
+        }
+        walker.visitor.finish();
+        return {};
+    }
+
+    std::string write_json(std::span<char const> data, BinCompat const* compat, BinUnhasher const* unhasher,
+                           std::FILE* file, int indent_size) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        std::vector<char> buffer;
+        impl_binary_read::BinBinaryWalker<BinJsonVisitor> walker = {
+            { buffer, unhasher, indent_size }, { begin, begin, end, compat }, {}
+        };
+        walker.visitor.file = file;
+        if (!walker.process()) {
+            return walker.trace_error();
+        }
+        walker.visitor.finish();
+        if (walker.visitor.failed) {
+            return "Failed to write file!";
+        }
+        return {};
+    }
 }
@@ -2,6 +2,13 @@
 #include "bin_types_helper.hpp"
 #include "bin_numconv.hpp"
 #include "bin_strconv.hpp"
+#include "bin_scan.hpp"
+#include "bin_io_binary_compat.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <unordered_set>
 
 #define bin_assert(...) do { \
     if(auto start = reader.cur_; !(__VA_ARGS__)) { \
@@ -32,11 +39,16 @@ namespace ritobin::io::impl_text_read {
             return static_cast<size_t>(cur_ - beg_);
         }
 
-        template<char Symbol>
-        constexpr bool read_symbol() noexcept {
-            while (!is_eof() && one_of<' ', '\t', '\r'>(*cur_)) {
-                cur_++;
+        inline void skip_space() noexcept {
+            // most tokens aren't preceded by any space so don't bother calling kernel for those
+            if (!is_eof() && one_of<' ', '\t', '\r'>(*cur_)) {
+                cur_ = scan_space(cur_ + 1, cap_);
             }
+        }
+
+        template<char Symbol>
+        bool read_symbol() noexcept {
+            skip_space();
             if (cur_ != cap_ && *cur_ == Symbol) {
                 cur_++;
                 return true;
@@ -44,21 +56,19 @@ namespace ritobin::io::impl_text_read {
             return false;
         }
 
-        constexpr bool next_newline() noexcept {
-            bool comment = false;
+        bool next_newline() noexcept {
             bool newline = false;
-            while (!is_eof()) {
-                if (one_of<' ', '\t', '\r'>(*cur_)) {
-                    cur_++;
+            for (;;) {
+                skip_space();
+                if (is_eof()) {
+                    break;
                 } else if (*cur_ == '\n') {
-                    comment = false;
                     newline = true;
                     cur_++;
                 } else if (*cur_ == '#') {
-                    comment = true;
-                    cur_++;
-                } else if (comment) {
-                    cur_++;
+                    // comment runs until newline which is left to be read as one
+                    auto const found = (char const*)memchr(cur_, '\n', (size_t)(cap_ - cur_));
+                    cur_ = found ? found : cap_;
                 } else {
                     break;
                 }
@@ -66,21 +76,14 @@ namespace ritobin::io::impl_text_read {
             return newline;
         }
 
-        constexpr std::string_view read_word() noexcept {
-            while (!is_eof() && one_of<' ', '\t', '\r'>(*cur_)) {
-                cur_++;
-            }
+        std::string_view read_word() noexcept {
+            skip_space();
             auto const beg = cur_;
-            while (!is_eof() && (one_of<'_', '+', '-', '.'>(*cur_)
-                || in_range<'A', 'Z'>(*cur_)
-                || in_range<'a', 'z'>(*cur_)
-                || in_range<'0', '9'>(*cur_))) {
-                cur_++;
-            }
+            cur_ = scan_word(cur_, cap_);
             return { beg, static_cast<size_t>(cur_ - beg) };
         }
 
-        constexpr bool read_nested_begin(bool& end) noexcept {
+        bool read_nested_begin(bool& end) noexcept {
             if (read_symbol<'{'>()) {
                 next_newline();
                 end = read_symbol<'}'>();
@@ -89,7 +92,7 @@ namespace ritobin::io::impl_text_read {
             return false;
         }
 
-        constexpr bool read_nested_separator() noexcept {
+        bool read_nested_separator() noexcept {
             if (next_newline()) {
                 return true;
             }
@@ -101,7 +104,7 @@ namespace ritobin::io::impl_text_read {
             return false;
         }
 
-        constexpr bool read_nested_separator_or_end(bool& end) noexcept {
+        bool read_nested_separator_or_end(bool& end) noexcept {
             if (read_symbol<'}'>()) {
                 end = true;
                 return true;
@@ -113,7 +116,7 @@ namespace ritobin::io::impl_text_read {
             return false;
         }
 
-        constexpr bool read_nested_separator_or_eof() noexcept {
+        bool read_nested_separator_or_eof() noexcept {
             if (is_eof()) {
                 return true;
             }
@@ -125,9 +128,7 @@ namespace ritobin::io::impl_text_read {
 
         bool read_string(std::string& result) noexcept {
             // FIXME: unicode verification
-            while (!is_eof() && one_of<' ', '\t', '\r'>(*cur_)) {
-                cur_++;
-            }
+            skip_space();
             if (cur_ == cap_) {
                 return false;
             }
@@ -280,22 +281,61 @@ namespace ritobin::io::impl_text_read {
     struct BinTextReader {
         TextReader reader;
         std::vector<std::pair<std::string, char const*>> error;
+        size_t threads = 1;
+        TextSource* source = nullptr;
 
         bool process_bin(Bin& bin) noexcept {
             reader.next_newline();
             while (!reader.is_eof()) {
                 std::string section_name = {};
                 Value section_value = {};
+                TextSource::Section section_source = {};
                 bin_assert(reader.read_name(section_name));
                 bin_assert(read_value_type(section_value));
                 bin_assert(reader.read_symbol<'='>());
-                bin_assert(read_value(section_value));
+                if (auto map = std::get_if<Map>(&section_value); map && source) {
+                    bin_assert(read_map_source(*map, section_source));
+                } else if (threads <= 1 || !read_map_parallel(section_value)) {
+                    bin_assert(read_value(section_value));
+                }
                 bin_assert(reader.is_eof() || reader.read_nested_separator());
-                bin.sections.emplace(std::move(section_name), std::move(section_value));
+                auto const is_map = std::holds_alternative<Map>(section_value);
+                if (bin.sections.emplace(section_name, std::move(section_value)).second && is_map && source) {
+                    section_source.name = std::move(section_name);
+                    source->sections.push_back(std::move(section_source));
+                }
+            }
+            if (source) {
+                source->size = static_cast<size_t>(reader.cap_ - reader.beg_);
             }
             return true;
         }
 
+        // Reads items of map section that replace items touched by edit, from end of last untouched item before edit
+        // or from opening brace up to start of first untouched item after edit or past closing brace.
+        // Fails when items don't end exactly there, whole text is read again then to report errors.
+        bool process_map_splice(PairList& items, std::vector<TextSource::Item>& ranges, Map const& map,
+                                bool first, char const* stop, bool last) noexcept {
+            bool end = false;
+            if (first ? !reader.read_nested_begin(end) : !reader.read_nested_separator_or_end(end)) {
+                return false;
+            }
+            while (!end) {
+                if (!last && reader.cur_ == stop) {
+                    return true;
+                }
+                auto const begin = reader.position();
+                if (reader.cur_ > stop || !read_pair(items, map.keyType, map.valueType)) {
+                    return false;
+                }
+                ranges.push_back({ begin, reader.position() });
+                if (reader.cur_ > stop || !reader.read_nested_separator_or_end(end)) {
+                    return false;
+                }
+            }
+            return last && reader.cur_ == stop;
+        }
+
         bool process_value(Value& value) noexcept {
             reader.next_newline();
             bin_assert(read_value(value));
@@ -333,6 +373,140 @@ namespace ritobin::io::impl_text_read {
             error.emplace_back(msg, pos);
             return false;
         }
+
+        // Same as reading map value but remembers where each item is
+        bool read_map_source(Map& value, TextSource::Section& section) noexcept {
+            bool end = false;
+            reader.skip_space();
+            section.open = reader.position();
+            bin_assert(reader.read_nested_begin(end));
+            while (!end) {
+                auto const begin = reader.position();
+                bin_assert(read_pair(value.items, value.keyType, value.valueType));
+                section.items.push_back({ begin, reader.position() });
+                bin_assert(reader.read_nested_separator_or_end(end));
+            }
+            section.close = reader.position() - 1;
+            return true;
+        }
+
+        // Finds where top level items of map end by counting braces outside of strings and comments.
+        // Returns position after closing brace of map or nullptr if it isn't found.
+        static char const* find_map_items(char const* cur, char const* cap, std::vector<char const*>& ends) noexcept {
+            size_t depth = 0;
+            while ((cur = scan_nesting(cur, cap)) != cap) {
+                switch (*cur) {
+                case '{':
+                    depth++;
+                    cur++;
+                    break;
+                case '}':
+                    cur++;
+                    if (depth == 0) {
+                        return cur;
+                    }
+                    if (--depth == 0) {
+                        ends.push_back(cur);
+                    }
+                    break;
+                case '"':
+                case '\'':
+                    cur = str_unquote_fetch_end({ cur, static_cast<size_t>(cap - cur) });
+                    if (cur == cap) {
+                        return nullptr;
+                    }
+                    cur++;
+                    break;
+                case '#':
+                    if (cur = static_cast<char const*>(memchr(cur, '\n', static_cast<size_t>(cap - cur))); !cur) {
+                        return nullptr;
+                    }
+                    break;
+                }
+            }
+            return nullptr;
+        }
+
+        // Reads items of map section on multiple threads, split between items found by pre-scan.
+        // Each chunk takes same steps as sequential read from same position and has to stop exactly at its split,
+        // so result is the same. On anything unexpected it gives up leaving sequential read to report exact error.
+        bool read_map_parallel(Value& value) noexcept {
+            auto const map = std::get_if<Map>(&value);
+            if (!map) {
+                return false;
+            }
+            auto const start = reader.cur_;
+            bool end = false;
+            if (!reader.read_nested_begin(end) || end) {
+                reader.cur_ = start;
+                return false;
+            }
+            constexpr size_t chunk = 64;
+            std::vector<char const*> splits = { reader.cur_ };
+            auto const map_end = find_map_items(reader.cur_, reader.cap_, splits);
+            if (!map_end || splits.size() <= chunk + 1) {
+                reader.cur_ = start;
+                return false;
+            }
+            // last found item end is replaced by closing brace of map as last chunk reads until map ends
+            splits.back() = map_end;
+
+            auto const chunks = (splits.size() - 1 + chunk - 1) / chunk;
+            auto const workers = std::min(threads, chunks);
+            std::atomic<size_t> next = 0;
+            std::atomic<bool> failed = false;
+            std::vector<PairList> results(chunks);
+            auto work = [&, this] {
+                for (size_t index = next++; index < chunks && !failed; index = next++) {
+                    auto const first = index * chunk;
+                    auto const last = std::min(first + chunk, splits.size() - 1);
+                    BinTextReader chunkReader = { { reader.beg_, splits[first], reader.cap_ }, {} };
+                    if (!chunkReader.read_map_items(results[index], *map, first == 0, splits[last], last == splits.size() - 1)) {
+                        failed = true;
+                    }
+                }
+            };
+            std::vector<std::thread> pool;
+            for (size_t i = 1; i < workers; i++) {
+                pool.emplace_back(work);
+            }
+            work();
+            for (auto& thread : pool) {
+                thread.join();
+            }
+
+            if (failed) {
+                reader.cur_ = start;
+                return false;
+            }
+            for (auto& items: results) {
+                map->items.insert(map->items.end(), std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+            }
+            reader.cur_ = map_end;
+            return true;
+        }
+
+        // Separator following previous chunk's last item is read at start of next chunk
+        bool read_map_items(PairList& items, Map const& map, bool first, char const* split, bool last) noexcept {
+            bool end = false;
+            if (!first && (!reader.read_nested_separator_or_end(end) || end)) {
+                return false;
+            }
+            for (;;) {
+                if (!read_pair(items, map.keyType, map.valueType)) {
+                    return false;
+                }
+                if (!last && reader.cur_ == split) {
+                    return true;
+                }
+                if (reader.cur_ >= split || !reader.read_nested_separator_or_end(end)) {
+                    return false;
+                }
+                if (end) {
+                    return last && reader.cur_ == split;
+                }
+            }
+        }
     
         bool read_value_type(Value& value) noexcept {
             Type type = {};
@@ -592,6 +766,589 @@ namespace ritobin::io::impl_text_read {
     };
 }
 
+namespace ritobin::io::impl_text_read {
+    // Compiles text straight into binary .bin while it is read, without building Bin first.
+    // Lengths and counts are filled in once their container closes. Sections can come in any order
+    // so each one gets its own buffer, sections are checked and put together the way write_binary would do it.
+    template<typename Compat>
+    struct BinTextAssembler {
+        struct ValueType {
+            Type type = {};
+            Type keyType = {};
+            Type valueType = {};
+        };
+
+        struct Section {
+            char const* pos = {};
+            bool valid = {};
+        };
+
+        TextReader reader;
+        Compat const* compat;
+        std::vector<std::pair<std::string, char const*>> error = {};
+
+        bool process(std::vector<char>& result) noexcept {
+            reader.next_newline();
+            while (!reader.is_eof()) {
+                std::string section_name = {};
+                ValueType type = {};
+                bin_assert(reader.read_name(section_name));
+                bin_assert(read_value_type(type));
+                bin_assert(reader.read_symbol<'='>());
+                bin_assert(read_section(section_name, type));
+                bin_assert(reader.is_eof() || reader.read_nested_separator());
+            }
+            // errors point back to section they are about
+            return finish(result);
+        }
+
+        std::string trace_error() noexcept {
+            BinTextReader text = { reader, std::move(error) };
+            return text.trace_error();
+        }
+        // Buffer values are currently written to
+        std::vector<char>* out_ = {};
+        // Sections Bin wouldn't keep or write are only parsed
+        bool discard_ = {};
+        std::string string_ = {};
+        std::unordered_set<std::string> seen_ = {};
+        Section type_ = {};
+        std::string type_value_ = {};
+        Section version_ = {};
+        uint32_t version_value_ = {};
+        Section linked_ = {};
+        uint32_t linked_count_ = {};
+        std::vector<char> linked_data_ = {};
+        Section entries_ = {};
+        std::vector<uint32_t> entry_names_ = {};
+        std::vector<char> entries_data_ = {};
+        Section patches_ = {};
+        uint32_t patch_count_ = {};
+        std::vector<char> patches_data_ = {};
+        std::vector<char> patch_fields_ = {};
+        char const* patch_error_ = {};
+        char const* patch_error_pos_ = {};
+        std::vector<char> discarded_ = {};
+
+    private:
+        bool fail_msg(char const* msg, char const* pos) noexcept {
+            error.emplace_back(msg, pos);
+            return false;
+        }
+
+        bool read_value_type(ValueType& value) noexcept {
+            bin_assert(reader.read_symbol<':'>());
+            bin_assert(reader.read_typename(value.type));
+            if (value.type == Type::LIST || value.type == Type::LIST2 || value.type == Type::OPTION) {
+                bin_assert(reader.read_symbol<'['>());
+                bin_assert(reader.read_typename(value.valueType));
+                bin_assert(!ValueHelper::is_container(value.valueType));
+                bin_assert(reader.read_symbol<']'>());
+            } else if (value.type == Type::MAP) {
+                bin_assert(reader.read_symbol<'['>());
+                bin_assert(reader.read_typename(value.keyType));
+                bin_assert(ValueHelper::is_primitive(value.keyType));
+                bin_assert(reader.read_symbol<','>());
+                bin_assert(reader.read_typename(value.valueType));
+                bin_assert(!ValueHelper::is_container(value.valueType));
+                bin_assert(reader.read_symbol<']'>());
+            }
+            return true;
+        }
+
+        // Same as Bin::sections.emplace, only first section with given name is kept
+        bool read_section(std::string const& name, ValueType const& type) noexcept {
+            auto const pos = reader.cur_;
+            if (!seen_.insert(name).second) {
+                bin_assert(discard(type));
+                return true;
+            }
+            if (name == "type") {
+                type_ = { pos, type.type == Type::STRING };
+                if (type_.valid) {
+                    bin_assert(reader.read_string(type_value_));
+                    return true;
+                }
+            } else if (name == "version") {
+                version_ = { pos, type.type == Type::U32 };
+                if (version_.valid) {
+                    bin_assert(reader.read_number(version_value_));
+                    return true;
+                }
+            } else if (name == "linked") {
+                linked_ = { pos, type.type == Type::LIST && type.valueType == Type::STRING };
+                if (linked_.valid) {
+                    bin_assert(write_linked());
+                    return true;
+                }
+            } else if (name == "entries") {
+                entries_ = { pos, type.type == Type::MAP && type.keyType == Type::HASH && type.valueType == Type::EMBED };
+                if (entries_.valid) {
+                    bin_assert(write_entries());
+                    return true;
+                }
+            } else if (name == "patches") {
+                patches_ = { pos, type.type == Type::MAP && type.keyType == Type::HASH && type.valueType == Type::EMBED };
+                if (patches_.valid) {
+                    bin_assert(write_patches());
+                    return true;
+                }
+            }
+            bin_assert(discard(type));
+            return true;
+        }
+
+        bool discard(ValueType const& type) noexcept {
+            discarded_.clear();
+            out_ = &discarded_;
+            discard_ = true;
+            bin_assert(write_value(type));
+            discard_ = false;
+            return true;
+        }
+
+        bool write_linked() noexcept {
+            out_ = &linked_data_;
+            bool end = false;
+            bin_assert(reader.read_nested_begin(end));
+            while (!end) {
+                bin_assert(write_value({ Type::STRING }));
+                linked_count_++;
+                bin_assert(reader.read_nested_separator_or_end(end));
+            }
+            return true;
+        }
+
+        bool write_entries() noexcept {
+            out_ = &entries_data_;
+            bool end = false;
+            bin_assert(reader.read_nested_begin(end));
+            while (!end) {
+                FNV1a key = {};
+                FNV1a name = {};
+                bin_assert(reader.read_hash_string(key));
+                bin_assert(reader.read_symbol<'='>());
+                bin_assert(reader.read_hash_name(name));
+                entry_names_.push_back(name.hash());
+                auto const length = begin_length();
+                write(key.hash());
+                bin_assert(write_fields());
+                end_length(length);
+                bin_assert(reader.read_nested_separator_or_end(end));
+            }
+            return true;
+        }
+
+        // Patch fields can come in any order while binary has value type and path before value
+        bool write_patches() noexcept {
+            bool end = false;
+            bin_assert(reader.read_nested_begin(end));
+            while (!end) {
+                FNV1a key = {};
+                FNV1a name = {};
+                auto const pos = reader.cur_;
+                bin_assert(reader.read_hash_string(key));
+                bin_assert(reader.read_symbol<'='>());
+                bin_assert(reader.read_hash_name(name));
+                bin_assert(write_patch(key, pos));
+                patch_count_++;
+                bin_assert(reader.read_nested_separator_or_end(end));
+            }
+            return true;
+        }
+
+        bool write_patch(FNV1a const& key, char const* pos) noexcept {
+            static uint32_t const path_hash = FNV1a("path").hash();
+            static uint32_t const value_hash = FNV1a("value").hash();
+            struct {
+                Type type = {};
+                size_t beg = {};
+                size_t end = {};
+                bool found = {};
+            } path = {}, value = {};
+            patch_fields_.clear();
+            out_ = &patch_fields_;
+            bool end = false;
+            bin_assert(reader.read_nested_begin(end));
+            while (!end) {
+                FNV1a name = {};
+                ValueType type = {};
+                bin_assert(reader.read_hash_name(name));
+                bin_assert(read_value_type(type));
+                bin_assert(reader.read_symbol<'='>());
+                auto const beg = patch_fields_.size();
+                bin_assert(write_value(type));
+                if (name.hash() == path_hash && !path.found) {
+                    path = { type.type, beg, patch_fields_.size(), true };
+                } else if (name.hash() == value_hash && !value.found) {
+                    value = { type.type, beg, patch_fields_.size(), true };
+                }
+                bin_assert(reader.read_nested_separator_or_end(end));
+            }
+            out_ = &patches_data_;
+            if (patch_error_) {
+                return true;
+            }
+            if (!path.found || !value.found || path.type != Type::STRING) {
+                patch_error_ = !path.found ? "Patch has no path!" : !value.found ? "Patch has no value!" : "Patch path is not string!";
+                patch_error_pos_ = pos;
+                return true;
+            }
+            write(key.hash());
+            auto const length = begin_length();
+            if (!write_type(value.type)) {
+                patch_error_ = "Patch value type has no raw type!";
+                patch_error_pos_ = pos;
+                return true;
+            }
+            write(std::span<char const>(patch_fields_.data() + path.beg, path.end - path.beg));
+            write(std::span<char const>(patch_fields_.data() + value.beg, value.end - value.beg));
+            end_length(length);
+            return true;
+        }
+
+        // Embed and pointer contents, count and fields
+        bool write_fields() noexcept {
+            auto const count_at = out_->size();
+            write(uint16_t{});
+            size_t count = 0;
+            bool end = false;
+            bin_assert(reader.read_nested_begin(end));
+            while (!end) {
+                FNV1a name = {};
+                ValueType type = {};
+                bin_assert(reader.read_hash_name(name));
+                bin_assert(read_value_type(type));
+                bin_assert(reader.read_symbol<'='>());
+                write(name.hash());
+                bin_assert(write_type(type.type));
+                bin_assert(write_value(type));
+                count++;
+                bin_assert(reader.read_nested_separator_or_end(end));
+            }
+            write_at(count_at, static_cast<uint16_t>(count));
+            return true;
+        }
+
+        bool write_items(Type type, size_t& count) noexcept {
+            bool end = false;
+            bin_assert(reader.read_nested_begin(end));
+            while (!end) {
+                bin_assert(write_value({ type }));
+                count++;
+                bin_assert(reader.read_nested_separator_or_end(end));
+            }
+            return true;
+        }
+
+        bool write_value(ValueType const& type) noexcept {
+            switch (type.type) {
+            case Type::NONE: {
+                std::string name;
+                bin_assert(reader.read_name(name));
+                bin_assert(name == "null");
+                return true;
+            }
+            case Type::BOOL:
+            case Type::FLAG: {
+                bool value = {};
+                bin_assert(reader.read_bool(value));
+                write(static_cast<uint8_t>(value));
+                return true;
+            }
+            case Type::I8: return write_number<int8_t>();
+            case Type::U8: return write_number<uint8_t>();
+            case Type::I16: return write_number<int16_t>();
+            case Type::U16: return write_number<uint16_t>();
+            case Type::I32: return write_number<int32_t>();
+            case Type::U32: return write_number<uint32_t>();
+            case Type::I64: return write_number<int64_t>();
+            case Type::U64: return write_number<uint64_t>();
+            case Type::F32: return write_number<float>();
+            case Type::VEC2: return write_array<float, 2>();
+            case Type::VEC3: return write_array<float, 3>();
+            case Type::VEC4: return write_array<float, 4>();
+            case Type::MTX44: return write_array<float, 16>();
+            case Type::RGBA: return write_array<uint8_t, 4>();
+            case Type::STRING: {
+                bin_assert(reader.read_string(string_));
+                write(static_cast<uint16_t>(string_.size()));
+                write(std::span<char const>(string_));
+                return true;
+            }
+            case Type::HASH:
+            case Type::LINK: {
+                FNV1a value = {};
+                bin_assert(reader.read_hash_string(value));
+                write(value.hash());
+                return true;
+            }
+            case Type::FILE: {
+                XXH64 value = {};
+                bin_assert(reader.read_hash_string(value));
+                write(value.hash());
+                return true;
+            }
+            case Type::LIST:
+            case Type::LIST2: {
+                bin_assert(write_type(type.valueType));
+                auto const length = begin_length();
+                auto const count_at = out_->size();
+                write(uint32_t{});
+                size_t count = 0;
+                bin_assert(write_items(type.valueType, count));
+                write_at(count_at, static_cast<uint32_t>(count));
+                end_length(length);
+                return true;
+            }
+            case Type::OPTION: {
+                bin_assert(write_type(type.valueType));
+                auto const count_at = out_->size();
+                write(uint8_t{});
+                bool end = false;
+                bin_assert(reader.read_nested_begin(end));
+                if (!end) {
+                    bin_assert(write_value({ type.valueType }));
+                    bin_assert(reader.read_nested_separator_or_end(end));
+                    bin_assert(end);
+                    write_at(count_at, uint8_t{ 1 });
+                }
+                return true;
+            }
+            case Type::MAP: {
+                bin_assert(write_type(type.keyType));
+                bin_assert(write_type(type.valueType));
+                auto const length = begin_length();
+                auto const count_at = out_->size();
+                write(uint32_t{});
+                size_t count = 0;
+                bool end = false;
+                bin_assert(reader.read_nested_begin(end));
+                while (!end) {
+                    bin_assert(write_value({ type.keyType }));
+                    bin_assert(reader.read_symbol<'='>());
+                    bin_assert(write_value({ type.valueType }));
+                    count++;
+                    bin_assert(reader.read_nested_separator_or_end(end));
+                }
+                write_at(count_at, static_cast<uint32_t>(count));
+                end_length(length);
+                return true;
+            }
+            case Type::POINTER:
+            case Type::EMBED: {
+                FNV1a name = {};
+                bin_assert(reader.read_hash_name(name));
+                if (type.type == Type::POINTER && name.str() == "null") {
+                    write(uint32_t{});
+                    return true;
+                }
+                write(name.hash());
+                auto const length = begin_length();
+                bin_assert(write_fields());
+                end_length(length);
+                // pointer with 0 name is written as null, its fields are dropped
+                if (type.type == Type::POINTER && name.hash() == 0) {
+                    out_->resize(length);
+                }
+                return true;
+            }
+            }
+            bin_assert(false);
+            return false;
+        }
+
+        template<typename T>
+        bool write_number() noexcept {
+            T value = {};
+            bin_assert(reader.read_number(value));
+            write(value);
+            return true;
+        }
+
+        template<typename T, size_t S>
+        bool write_array() noexcept {
+            std::array<T, S> value = {};
+            uint32_t counter = 0;
+            bool end = false;
+            bin_assert(reader.read_nested_begin(end));
+            while (!end) {
+                bin_assert(counter < S);
+                bin_assert(reader.read_number(value[counter]));
+                bin_assert(reader.read_nested_separator_or_end(end));
+                counter++;
+            }
+            bin_assert(counter == static_cast<uint32_t>(S));
+            write(std::span<char const>(reinterpret_cast<char const*>(value.data()), sizeof(value)));
+            return true;
+        }
+
+        bool write_type(Type type) noexcept {
+            uint8_t raw = {};
+            if (!compat->type_to_raw(type, raw) && !discard_) {
+                return false;
+            }
+            write(raw);
+            return true;
+        }
+
+        template<typename T>
+        void write(T value) noexcept {
+            static_assert(std::is_arithmetic_v<T>);
+            auto const at = out_->size();
+            out_->resize(at + sizeof(T));
+            memcpy(out_->data() + at, &value, sizeof(T));
+        }
+
+        void write(std::span<char const> value) noexcept {
+            out_->insert(out_->end(), value.begin(), value.end());
+        }
+
+        template<typename T>
+        void write_at(size_t at, T value) noexcept {
+            memcpy(out_->data() + at, &value, sizeof(T));
+        }
+
+        size_t begin_length() noexcept {
+            auto const at = out_->size();
+            write(uint32_t{});
+            return at;
+        }
+
+        void end_length(size_t at) noexcept {
+            write_at(at, static_cast<uint32_t>(out_->size() - at - sizeof(uint32_t)));
+        }
+
+        // Same checks as write_binary does on Bin, in same order
+        bool finish(std::vector<char>& result) noexcept {
+            if (!type_.pos) {
+                return fail_msg("Missing type section!", reader.cur_);
+            }
+            if (!type_.valid) {
+                return fail_msg("Type section is not string!", type_.pos);
+            }
+            if (type_value_ != "PROP" && type_value_ != "PTCH") {
+                return fail_msg("Type is not PROP or PTCH!", type_.pos);
+            }
+            if (!version_.pos) {
+                return fail_msg("Missing version section!", reader.cur_);
+            }
+            if (!version_.valid) {
+                return fail_msg("Version section is not u32!", version_.pos);
+            }
+            auto const is_patch = type_value_ == "PTCH";
+            auto const has_linked = version_value_ >= 2;
+            auto const has_patches = version_value_ >= 3 && is_patch;
+            if (has_linked && linked_.pos && !linked_.valid) {
+                return fail_msg("Linked section is not list[string]!", linked_.pos);
+            }
+            if (entries_.pos && !entries_.valid) {
+                return fail_msg("Entries section is not map[hash,embed]!", entries_.pos);
+            }
+            if (has_patches && patches_.pos && !patches_.valid) {
+                return fail_msg("Patches section is not map[hash,embed]!", patches_.pos);
+            }
+            if (has_patches && patch_error_) {
+                return fail_msg(patch_error_, patch_error_pos_);
+            }
+
+            result.clear();
+            result.reserve(sizeof(uint32_t) * 8 + linked_data_.size() + sizeof(uint32_t) * entry_names_.size()
+                           + entries_data_.size() + patches_data_.size());
+            out_ = &result;
+            if (is_patch) {
+                write(std::span<char const>("PTCH", 4));
+                write(uint32_t{ 1 });
+                write(uint32_t{ 0 });
+            }
+            write(std::span<char const>("PROP", 4));
+            write(version_value_);
+            if (has_linked) {
+                write(linked_count_);
+                write(std::span<char const>(linked_data_));
+            }
+            write(static_cast<uint32_t>(entry_names_.size()));
+            for (auto name : entry_names_) {
+                write(name);
+            }
+            write(std::span<char const>(entries_data_));
+            if (has_patches) {
+                write(patch_count_);
+                write(std::span<char const>(patches_data_));
+            }
+            return true;
+        }
+    };
+}
+
+namespace ritobin::io::impl_text_read {
+    // Parses again only items of map section touched by edit and splices them into map read before edit.
+    // False when edit isn't inside items of single map section or new items don't line up with untouched ones.
+    static bool read_text_splice(Bin& bin, std::span<char const> data, TextSource& source, TextEdit const& edit) noexcept {
+        if (edit.offset > source.size || edit.removed > source.size - edit.offset
+            || data.size() != source.size - edit.removed + edit.inserted) {
+            return false;
+        }
+        auto const edit_end = edit.offset + edit.removed;
+        // braces themselves must stay
+        auto const section = std::find_if(source.sections.begin(), source.sections.end(), [&](auto const& section) {
+            return section.open < edit.offset && edit_end <= section.close;
+        });
+        if (section == source.sections.end()) {
+            return false;
+        }
+        auto const found = bin.sections.find(section->name);
+        if (found == bin.sections.end()) {
+            return false;
+        }
+        auto const map = std::get_if<Map>(&found->second);
+        auto& ranges = section->items;
+        if (!map || map->items.size() != ranges.size()) {
+            return false;
+        }
+        // reading item looks at one char past its end so edit starting right there touches it as well
+        auto const first = static_cast<size_t>(std::partition_point(ranges.begin(), ranges.end(), [&](auto const& item) {
+            return item.end < edit.offset;
+        }) - ranges.begin());
+        auto const last = static_cast<size_t>(std::partition_point(ranges.begin(), ranges.end(), [&](auto const& item) {
+            return item.begin <= edit_end;
+        }) - ranges.begin());
+        auto const shift = [&](size_t position) {
+            return position - edit.removed + edit.inserted;
+        };
+
+        auto const begin = data.data();
+        auto const start = first == 0 ? section->open : ranges[first - 1].end;
+        auto const stop = shift(last == ranges.size() ? section->close + 1 : ranges[last].begin);
+        PairList items = {};
+        std::vector<TextSource::Item> items_ranges = {};
+        BinTextReader reader = { { begin, begin + start, begin + data.size() }, {} };
+        if (!reader.process_map_splice(items, items_ranges, *map, first == 0, begin + stop, last == ranges.size())) {
+            return false;
+        }
+
+        map->items.erase(map->items.begin() + first, map->items.begin() + last);
+        map->items.insert(map->items.begin() + first, std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+        ranges.erase(ranges.begin() + first, ranges.begin() + last);
+        ranges.insert(ranges.begin() + first, items_ranges.begin(), items_ranges.end());
+        for (auto& item : std::span(ranges).subspan(first + items_ranges.size())) {
+            item = { shift(item.begin), shift(item.end) };
+        }
+        section->close = shift(section->close);
+        for (auto& other : source.sections) {
+            if (other.open > edit.offset && &other != &*section) {
+                other.open = shift(other.open);
+                other.close = shift(other.close);
+                for (auto& item : other.items) {
+                    item = { shift(item.begin), shift(item.end) };
+                }
+            }
+        }
+        source.size = data.size();
+        return true;
+    }
+}
+
 namespace ritobin::io {
     using namespace impl_text_read;
 
@@ -605,6 +1362,43 @@ namespace ritobin::io {
         return {};
     }
 
+    std::string read_text(Bin& bin, std::span<char const> data, size_t threads) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        if (threads == 0) {
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        BinTextReader reader = { { begin, begin, end }, {}, threads };
+        if (!reader.process_bin(bin)) {
+            return reader.trace_error();
+        }
+        return {};
+    }
+
+    std::string read_text(Bin& bin, std::span<char const> data, TextSource& source) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        source = {};
+        BinTextReader reader = { { begin, begin, end }, {}, 1, &source };
+        if (!reader.process_bin(bin)) {
+            source = {};
+            return reader.trace_error();
+        }
+        return {};
+    }
+
+    std::string read_text(Bin& bin, std::span<char const> data, TextSource& source, TextEdit const& edit) noexcept {
+        if (read_text_splice(bin, data, source, edit)) {
+            return {};
+        }
+        Bin result = {};
+        if (auto error = read_text(result, data, source); !error.empty()) {
+            return error;
+        }
+        bin = std::move(result);
+        return {};
+    }
+
     std::string read_text(Value& value, std::span<char const> data) noexcept {
         auto const begin = data.data();
         auto const end = data.data() + data.size();
@@ -644,4 +1438,16 @@ namespace ritobin::io {
         }
         return {};
     }
+
+    std::string assemble_binary(std::vector<char>& out, std::span<char const> data, BinCompat const* compat) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        return compat_impl::visit_compat(compat, [&]<typename Compat>(Compat const* compat) -> std::string {
+            BinTextAssembler<Compat> assembler = { { begin, begin, end }, compat };
+            if (!assembler.process(out)) {
+                return assembler.trace_error();
+            }
+            return {};
+        });
+    }
 }
@@ -2,6 +2,9 @@
 #include "bin_types_helper.hpp"
 #include "bin_numconv.hpp"
 #include "bin_strconv.hpp"
+#include "bin_io_binary_read.hpp"
+#include "bin_unhash.hpp"
+#include <algorithm>
 
 namespace ritobin::io::text_write_impl {
     struct TextWriter {
@@ -37,9 +40,9 @@ namespace ritobin::io::text_write_impl {
         template<typename T>
         void write(T value) noexcept {
             static_assert(std::is_arithmetic_v<T>);
-            std::string result;
-            from_num(result, value);
-            buffer_.insert(buffer_.end(), result.begin(), result.end());
+            char result[64];
+            auto const end = from_num(result, result + sizeof(result), value);
+            buffer_.insert(buffer_.end(), result, end);
         }
 
         template<typename T, size_t SIZE>
@@ -328,6 +331,430 @@ namespace ritobin::io::text_write_impl {
     };
 }
 
+namespace ritobin::io::text_write_impl {
+    // Writes same text as BinTextWriter straight from walker events so Bin never has to be built
+    // Only containers that are currently open are kept around, names are unhashed as they are written
+    struct BinTextVisitor {
+        enum class Items {
+            FIELDS,
+            ELEMENTS,
+            PAIRS,
+        };
+
+        struct Frame {
+            Items items;
+            uint32_t count;
+            bool null = {};
+            bool key = true;
+        };
+
+        TextWriter writer;
+        BinUnhasher const* unhasher = {};
+        // When set buffer is flushed to file whenever section that is next in order is being written
+        std::FILE* file = {};
+        bool failed = {};
+        std::vector<Frame> frames = {};
+        // Names of sections in order Bin would write them
+        std::vector<std::string> order = {};
+        size_t next_section = {};
+        // Sections that were written before their turn, moved out of buffer until they are due
+        std::vector<std::pair<std::string, std::vector<char>>> held = {};
+        std::string section = {};
+        size_t section_start = {};
+        uint32_t linked_count = {};
+        bool has_linked = {};
+
+        // Same depth limit as BinUnhasher::unhash_bin, value at depth of open containers is unhashed
+        static constexpr size_t max_depth = 100;
+
+        bool header(std::string_view type, uint32_t version) noexcept {
+            writer.buffer_.clear();
+            // set of sections is known from header, inserted in same order read_binary does
+            // so Bin would iterate them in this order
+            Bin bin = {};
+            bin.sections.emplace("type", None{});
+            bin.sections.emplace("version", None{});
+            if (version >= 2) {
+                bin.sections.emplace("linked", None{});
+            }
+            bin.sections.emplace("entries", None{});
+            if (type == "PTCH") {
+                bin.sections.emplace("patches", None{});
+            }
+            for (auto const& [name, value] : bin.sections) {
+                order.push_back(name);
+            }
+            writer.write_raw("#PROP_text\n");
+            begin_section("type");
+            writer.write_raw("type: string = ");
+            writer.write(type);
+            writer.write_raw("\n");
+            begin_section("version");
+            writer.write_raw("version: u32 = ");
+            writer.write(version);
+            writer.write_raw("\n");
+            if (version >= 2) {
+                // linked count isn't known up front, braces are opened by first one
+                has_linked = true;
+                begin_section("linked");
+                writer.write_raw("linked: list[string] = ");
+            }
+            return true;
+        }
+
+        bool linked(std::string_view path) noexcept {
+            if (linked_count++ == 0) {
+                writer.write_raw("{\n");
+                writer.ident_inc();
+            }
+            writer.pad();
+            writer.write(path);
+            writer.write_raw("\n");
+            return true;
+        }
+
+        // Entries would be held in full until patches that come before them are written
+        bool patches_first() const noexcept {
+            return std::find(order.begin(), order.end(), "patches") < std::find(order.begin(), order.end(), "entries");
+        }
+
+        bool begin_entries(uint32_t count) noexcept {
+            end_linked();
+            begin_section("entries");
+            writer.write_raw("entries: map[hash,embed] = ");
+            open(Items::PAIRS, count);
+            return true;
+        }
+
+        bool end_entries() noexcept {
+            close();
+            return true;
+        }
+
+        bool begin_entry(uint32_t key, uint32_t name, uint16_t count) noexcept {
+            begin_value(Type::HASH);
+            write_string(key);
+            end_value();
+            begin_value(Type::EMBED);
+            write_name(name);
+            writer.write_raw(" ");
+            open(Items::FIELDS, count);
+            return true;
+        }
+
+        bool end_entry() noexcept {
+            close();
+            flush(false);
+            return true;
+        }
+
+        bool begin_patches(uint32_t count) noexcept {
+            end_linked();
+            begin_section("patches");
+            writer.write_raw("patches: map[hash,embed] = ");
+            open(Items::PAIRS, count);
+            return true;
+        }
+
+        bool end_patches() noexcept {
+            close();
+            return true;
+        }
+
+        bool begin_patch(uint32_t key, std::string_view path, Type) noexcept {
+            begin_value(Type::HASH);
+            write_string(key);
+            end_value();
+            begin_value(Type::EMBED);
+            writer.write_raw("patch ");
+            open(Items::FIELDS, 2);
+            writer.pad();
+            writer.write_raw("path: string = ");
+            writer.write(path);
+            writer.write_raw("\n");
+            writer.pad();
+            writer.write_raw("value: ");
+            return true;
+        }
+
+        bool end_patch() noexcept {
+            close();
+            flush(false);
+            return true;
+        }
+
+        bool field(uint32_t key, Type) noexcept {
+            writer.pad();
+            // field names belong to class one level up
+            write_name(key, frames.size() - 1);
+            writer.write_raw(": ");
+            return true;
+        }
+
+        bool value(ValueView const& value) noexcept {
+            begin_value(value.type);
+            switch (value.type) {
+            case Type::BOOL: write_view<Bool>(value); break;
+            case Type::I8: write_view<I8>(value); break;
+            case Type::U8: write_view<U8>(value); break;
+            case Type::I16: write_view<I16>(value); break;
+            case Type::U16: write_view<U16>(value); break;
+            case Type::I32: write_view<I32>(value); break;
+            case Type::U32: write_view<U32>(value); break;
+            case Type::I64: write_view<I64>(value); break;
+            case Type::U64: write_view<U64>(value); break;
+            case Type::F32: write_view<F32>(value); break;
+            case Type::VEC2: write_view<Vec2>(value); break;
+            case Type::VEC3: write_view<Vec3>(value); break;
+            case Type::VEC4: write_view<Vec4>(value); break;
+            case Type::MTX44: write_view<Mtx44>(value); break;
+            case Type::RGBA: write_view<RGBA>(value); break;
+            case Type::STRING: write_view<String>(value); break;
+            case Type::FLAG: write_view<Flag>(value); break;
+            case Type::HASH:
+            case Type::LINK: {
+                uint32_t hash = {};
+                memcpy(&hash, value.data, sizeof(hash));
+                write_string(hash);
+                break;
+            }
+            case Type::FILE: {
+                uint64_t hash = {};
+                memcpy(&hash, value.data, sizeof(hash));
+                write_string(hash);
+                break;
+            }
+            default:
+                break;
+            }
+            end_value();
+            return true;
+        }
+
+        bool begin_class(Type type, uint32_t name, uint16_t count) noexcept {
+            begin_value(type);
+            if (type == Type::POINTER && name == 0) {
+                writer.write_raw("null");
+                frames.push_back({ Items::FIELDS, 0, true });
+                return true;
+            }
+            write_name(name);
+            writer.write_raw(" ");
+            open(Items::FIELDS, count);
+            return true;
+        }
+
+        bool end_class() noexcept {
+            close();
+            return true;
+        }
+
+        bool begin_list(Type type, Type valueType, uint32_t count) noexcept {
+            begin_value(type, {}, valueType);
+            open(Items::ELEMENTS, count);
+            return true;
+        }
+
+        bool end_list() noexcept {
+            close();
+            return true;
+        }
+
+        bool begin_map(Type keyType, Type valueType, uint32_t count) noexcept {
+            begin_value(Type::MAP, keyType, valueType);
+            open(Items::PAIRS, count);
+            return true;
+        }
+
+        bool end_map() noexcept {
+            close();
+            return true;
+        }
+
+        // Sections come out in file order while Bin would write them in order of its unordered_map
+        void finish() noexcept {
+            end_section();
+            flush(true);
+        }
+    private:
+        // Closes linked list once whichever of entries or patches is walked first starts
+        void end_linked() noexcept {
+            if (!has_linked) {
+                return;
+            }
+            has_linked = false;
+            if (linked_count == 0) {
+                writer.write_raw("{}");
+            } else {
+                writer.ident_dec();
+                writer.pad();
+                writer.write_raw("}");
+            }
+            writer.write_raw("\n");
+        }
+
+        void begin_section(std::string name) noexcept {
+            end_section();
+            section = std::move(name);
+            section_start = writer.buffer_.size();
+        }
+
+        // Section that is due stays in buffer along with any held ones it was blocking, others are held
+        void end_section() noexcept {
+            if (section.empty()) {
+                return;
+            }
+            auto& buffer = writer.buffer_;
+            if (!is_due(section)) {
+                held.emplace_back(std::move(section), std::vector<char>(buffer.begin() + section_start, buffer.end()));
+                buffer.resize(section_start);
+                section.clear();
+                return;
+            }
+            section.clear();
+            next_section++;
+            for (auto i = held.begin(); i != held.end();) {
+                if (is_due(i->first)) {
+                    buffer.insert(buffer.end(), i->second.begin(), i->second.end());
+                    held.erase(i);
+                    next_section++;
+                    i = held.begin();
+                } else {
+                    ++i;
+                }
+            }
+        }
+
+        bool is_due(std::string const& name) const noexcept {
+            return next_section < order.size() && order[next_section] == name;
+        }
+
+        // Only output that is already in final order is in buffer while section that is due is being written
+        void flush(bool all) noexcept {
+            if (!file || failed || (!all && (writer.buffer_.size() < 1024 * 1024 || !is_due(section)))) {
+                return;
+            }
+            auto& buffer = writer.buffer_;
+            failed = fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() || (all && fflush(file) != 0);
+            buffer.clear();
+            section_start = 0;
+        }
+
+        // Field types are only known once their value starts as container types need their item types
+        void begin_value(Type type, Type keyType = {}, Type valueType = {}) noexcept {
+            if (frames.empty()) {
+                return;
+            }
+            auto const& frame = frames.back();
+            switch (frame.items) {
+            case Items::FIELDS:
+                writer.write(type);
+                if (type == Type::MAP) {
+                    writer.write_raw("[");
+                    writer.write(keyType);
+                    writer.write_raw(",");
+                    writer.write(valueType);
+                    writer.write_raw("]");
+                } else if (ValueHelper::is_container(type)) {
+                    writer.write_raw("[");
+                    writer.write(valueType);
+                    writer.write_raw("]");
+                }
+                writer.write_raw(" = ");
+                break;
+            case Items::ELEMENTS:
+                writer.pad();
+                break;
+            case Items::PAIRS:
+                if (frame.key) {
+                    writer.pad();
+                }
+                break;
+            }
+        }
+
+        void end_value() noexcept {
+            if (frames.empty()) {
+                writer.write_raw("\n");
+                return;
+            }
+            auto& frame = frames.back();
+            if (frame.items == Items::PAIRS) {
+                frame.key = !frame.key;
+                if (!frame.key) {
+                    writer.write_raw(" = ");
+                    return;
+                }
+            }
+            writer.write_raw("\n");
+        }
+
+        void open(Items items, uint32_t count) noexcept {
+            frames.push_back({ items, count });
+            if (count == 0) {
+                writer.write_raw("{}");
+                return;
+            }
+            writer.write_raw("{\n");
+            writer.ident_inc();
+        }
+
+        void close() noexcept {
+            auto const frame = frames.back();
+            frames.pop_back();
+            if (!frame.null && frame.count != 0) {
+                writer.ident_dec();
+                writer.pad();
+                writer.write_raw("}");
+            }
+            end_value();
+        }
+
+        template<typename T>
+        void write_view(ValueView const& view) noexcept {
+            typename ViewValue<T>::type value = {};
+            (void)view.get<T>(value);
+            writer.write(value);
+        }
+
+        std::string const* find_name(uint32_t hash, size_t depth) const noexcept {
+            return unhasher && depth < max_depth ? unhasher->find_fnv1a(hash) : nullptr;
+        }
+
+        void write_name(uint32_t hash) noexcept {
+            write_name(hash, frames.size());
+        }
+
+        // Unhasher would replace hash with hash of name even when name is empty
+        void write_name(uint32_t hash, size_t depth) noexcept {
+            auto name = find_name(hash, depth);
+            if (name && !name->empty()) {
+                writer.write_raw(*name);
+            } else {
+                writer.write_hex(name ? FNV1a(*name).hash() : hash);
+            }
+        }
+
+        void write_string(uint32_t hash) noexcept {
+            auto name = find_name(hash, frames.size());
+            if (name && !name->empty()) {
+                writer.write(*name);
+            } else {
+                writer.write_hex(name ? FNV1a(*name).hash() : hash);
+            }
+        }
+
+        void write_string(uint64_t hash) noexcept {
+            auto name = unhasher && frames.size() < max_depth ? unhasher->find_xxh64(hash) : nullptr;
+            if (name && !name->empty()) {
+                writer.write(*name);
+            } else {
+                writer.write_hex(name ? XXH64(*name).hash() : hash);
+            }
+        }
+    };
+}
+
 namespace ritobin::io {
     using namespace text_write_impl;
 
@@ -338,4 +765,34 @@ namespace ritobin::io {
         }
         return {};
     }
+
+    std::string write_text(std::span<char const> data, BinCompat const* compat, BinUnhasher const* unhasher,
+                           std::vector<char>& out, size_t indent_size) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        using Walker = impl_binary_read::BinBinaryWalker<BinTextVisitor>;
+        Walker walker = { { { out, indent_size }, unhasher }, { begin, begin, end, compat }, {} };
+        if (!walker.process()) {
+            return walker.trace_error();
+        }
+        walker.visitor.finish();
+        return {};
+    }
+
+    std::string write_text(std::span<char const> data, BinCompat const* compat, BinUnhasher const* unhasher,
+                           std::FILE* file, size_t indent_size) noexcept {
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        using Walker = impl_binary_read::BinBinaryWalker<BinTextVisitor>;
+        std::vector<char> buffer;
+        Walker walker = { { { buffer, indent_size }, unhasher, file }, { begin, begin, end, compat }, {} };
+        if (!walker.process()) {
+            return walker.trace_error();
+        }
+        walker.visitor.finish();
+        if (walker.visitor.failed) {
+            return "Failed to write file!";
+        }
+        return {};
+    }
 }
@@ -0,0 +1,222 @@
+#include "bin_mmap.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ritobin::io::mmap_impl {
+    // Size of file behind stream or 0 if it can't be mapped (pipe, terminal, ...)
+    static size_t mappable_size(std::FILE* file) noexcept {
+#ifdef _WIN32
+        auto const handle = (HANDLE)_get_osfhandle(_fileno(file));
+        if (handle == INVALID_HANDLE_VALUE || GetFileType(handle) != FILE_TYPE_DISK) {
+            return 0;
+        }
+        LARGE_INTEGER size = {};
+        if (!GetFileSizeEx(handle, &size)) {
+            return 0;
+        }
+        return (size_t)size.QuadPart;
+#else
+        struct stat info = {};
+        if (fstat(fileno(file), &info) != 0 || !S_ISREG(info.st_mode)) {
+            return 0;
+        }
+        return (size_t)info.st_size;
+#endif
+    }
+
+    static void* map_file(std::FILE* file, size_t size, bool writable = false) noexcept {
+#ifdef _WIN32
+        auto const handle = (HANDLE)_get_osfhandle(_fileno(file));
+        auto const mapping = CreateFileMappingA(handle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                                (DWORD)((uint64_t)size >> 32), (DWORD)size, nullptr);
+        if (!mapping) {
+            return nullptr;
+        }
+        auto const view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+        // view keeps mapping object alive
+        CloseHandle(mapping);
+        return view;
+#else
+        auto const view = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                               writable ? MAP_SHARED : MAP_PRIVATE, fileno(file), 0);
+        if (view == MAP_FAILED) {
+            return nullptr;
+        }
+        madvise(view, size, MADV_SEQUENTIAL);
+        return view;
+#endif
+    }
+
+    // Sets file size with its blocks already allocated, writes through mapping of sparse file
+    // would only find out disk is full once they fault and that can't be reported
+    static bool allocate_file(std::FILE* file, size_t size) noexcept {
+#ifdef _WIN32
+        // growing file with SetEndOfFile allocates its clusters, SetFileValidData would also skip zeroing them
+        // but it needs a privilege regular users don't have
+        auto const handle = (HANDLE)_get_osfhandle(_fileno(file));
+        LARGE_INTEGER end = {};
+        end.QuadPart = (LONGLONG)size;
+        return handle != INVALID_HANDLE_VALUE && SetFilePointerEx(handle, end, nullptr, FILE_BEGIN) && SetEndOfFile(handle);
+#else
+        if (ftruncate(fileno(file), (off_t)size) != 0) {
+            return false;
+        }
+        if (size == 0) {
+            return true;
+        }
+#ifdef __APPLE__
+        fstore_t store = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)size, 0 };
+        return fcntl(fileno(file), F_PREALLOCATE, &store) != -1;
+#else
+        return posix_fallocate(fileno(file), 0, (off_t)size) == 0;
+#endif
+#endif
+    }
+
+    static bool flush_file(void* view, size_t size) noexcept {
+#ifdef _WIN32
+        return FlushViewOfFile(view, size) != 0;
+#else
+        return msync(view, size, MS_SYNC) == 0;
+#endif
+    }
+
+    static void unmap_file(void* view, [[maybe_unused]] size_t size) noexcept {
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+#else
+        munmap(view, size);
+#endif
+    }
+}
+
+namespace ritobin::io {
+    using namespace mmap_impl;
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , mapping_(std::exchange(other.mapping_, nullptr))
+        , mapping_size_(std::exchange(other.mapping_size_, 0))
+        , buffer_(std::move(other.buffer_)) {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            mapping_ = std::exchange(other.mapping_, nullptr);
+            mapping_size_ = std::exchange(other.mapping_size_, 0);
+            buffer_ = std::move(other.buffer_);
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile() noexcept {
+        close();
+    }
+
+    void MappedFile::close() noexcept {
+        if (mapping_) {
+            unmap_file(mapping_, mapping_size_);
+        }
+        data_ = {};
+        size_ = {};
+        mapping_ = {};
+        mapping_size_ = {};
+        buffer_ = {};
+    }
+
+    std::string MappedFile::open(std::string const& filename) noexcept {
+        auto file = fopen(filename.c_str(), "rb");
+        if (!file) {
+            return "Failed to open file: " + filename;
+        }
+        auto error = open(file);
+        fclose(file);
+        return error;
+    }
+
+    std::string MappedFile::create(std::string const& filename, size_t size) noexcept {
+        close();
+        auto file = fopen(filename.c_str(), "w+b");
+        if (!file) {
+            return "Failed to open file: " + filename;
+        }
+        if (!allocate_file(file, size)) {
+            fclose(file);
+            return "Failed to allocate file: " + filename;
+        }
+        if (size != 0) {
+            if (auto view = map_file(file, size, true)) {
+                mapping_ = view;
+                mapping_size_ = size;
+                data_ = static_cast<char*>(view);
+                size_ = size;
+            }
+        }
+        fclose(file);
+        if (size != 0 && !mapping_) {
+            return "Failed to map file: " + filename;
+        }
+        return {};
+    }
+
+    std::string MappedFile::flush() noexcept {
+        if (mapping_ && !flush_file(mapping_, mapping_size_)) {
+            return "Failed to write mapped file!";
+        }
+        return {};
+    }
+
+    std::string MappedFile::open(std::FILE* file) noexcept {
+        close();
+        auto const position = ftell(file);
+        if (auto const size = mappable_size(file); size != 0 && position >= 0 && (size_t)position <= size) {
+            if (auto view = map_file(file, size)) {
+                mapping_ = view;
+                mapping_size_ = size;
+                data_ = static_cast<char*>(view) + position;
+                size_ = size - (size_t)position;
+                return {};
+            }
+            // regular file that can't be mapped, size is known so read it in one go
+            buffer_.resize(size - (size_t)position);
+            if (fread(buffer_.data(), 1, buffer_.size(), file) != buffer_.size()) {
+                buffer_ = {};
+                return "Failed to read file!";
+            }
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            return {};
+        }
+        // pipes and terminals don't know their size, read straight into buffer growing it geometrically
+        for (size_t size = 0; !feof(file) && !ferror(file);) {
+            if (buffer_.size() == size) {
+                buffer_.resize(size < 4096 ? 64 * 1024 : size * 2);
+            }
+            size += fread(buffer_.data() + size, 1, buffer_.size() - size, file);
+            if (feof(file) || ferror(file)) {
+                buffer_.resize(size);
+            }
+        }
+        if (ferror(file)) {
+            buffer_ = {};
+            return "Failed to read file!";
+        }
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        return {};
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef BIN_MMAP_HPP
+#define BIN_MMAP_HPP
+
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ritobin::io {
+    struct MappedFile {
+        MappedFile() noexcept = default;
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator=(MappedFile const&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile() noexcept;
+
+        // Map file for reading, falls back to reading it into memory
+        std::string open(std::string const& filename) noexcept;
+        // Map already opened file from current position, falls back to reading until eof (pipes, stdin)
+        std::string open(std::FILE* file) noexcept;
+        // Create or truncate file to given size with its space allocated and map it for writing
+        std::string create(std::string const& filename, size_t size) noexcept;
+        // Write changes made through writable_span out to file, has to succeed before file is used
+        std::string flush() noexcept;
+        // Unmap and release memory
+        void close() noexcept;
+
+        inline std::span<char const> span() const noexcept {
+            return { data_, size_ };
+        }
+
+        // Only valid for files opened with create
+        inline std::span<char> writable_span() const noexcept {
+            return { data_, size_ };
+        }
+
+        inline bool is_mapped() const noexcept {
+            return mapping_ != nullptr;
+        }
+    private:
+        char* data_ = {};
+        size_t size_ = {};
+        void* mapping_ = {};
+        size_t mapping_size_ = {};
+        std::vector<char> buffer_ = {};
+    };
+}
+
+#endif // BIN_MMAP_HPP
@@ -2,29 +2,93 @@
 
 #ifndef MSVC
 #include <cstdio>
+#include <cstring>
+namespace ritobin::numconv_impl {
+    // sscanf goes through locale and needs null terminated copy, but it also takes leading '+', hex floats
+    // and trailing garbage such as "1.5f" which from_chars rejects, so it stays as fallback for those
+    template<typename T>
+    static bool scan_num(std::string_view str, T& num) noexcept {
+        char buffer[64];
+        auto copy = std::string();
+        auto cstr = buffer;
+        if (str.size() < sizeof(buffer)) {
+            memcpy(buffer, str.data(), str.size());
+            buffer[str.size()] = '\0';
+        } else {
+            copy = std::string(str.begin(), str.end());
+            cstr = copy.data();
+        }
+        if constexpr (std::is_same_v<T, float>) {
+            return sscanf(cstr, "%g", &num) == 1;
+        } else {
+            return sscanf(cstr, "%lg", &num) == 1;
+        }
+    }
+
+    // from_chars is correctly rounded, locale independent and doesn't allocate
+    template<typename T>
+    static bool parse_num(std::string_view str, T& num) noexcept {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        auto const [p, ec] = std::from_chars(str.data(), str.data() + str.size(), num);
+        if (ec == std::errc{} && p == str.data() + str.size()) {
+            return true;
+        }
+#endif
+        return scan_num(str, num);
+    }
+
+    // to_chars gives shortest text that round-trips, "%.9g" prints 0.1f as 0.100000001
+    template<typename T>
+    static char* format_num(char* first, char* last, T num) noexcept {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        auto const [p, ec] = std::to_chars(first, last, num);
+        if (ec == std::errc{}) {
+            return p;
+        }
+        return first;
+#else
+        auto const size = std::is_same_v<T, float>
+            ? snprintf(first, (size_t)(last - first), "%.9g", num)
+            : snprintf(first, (size_t)(last - first), "%.17lg", num);
+        if (size >= 0 && size < last - first) {
+            return first + size;
+        }
+        return first;
+#endif
+    }
+}
+
 namespace ritobin {
+    using namespace numconv_impl;
+
     bool to_num(std::string_view str, float& num) noexcept {
-        auto copy = std::string(str.begin(), str.end());
-        return sscanf(copy.c_str(), "%g", &num) == 1;
+        return parse_num(str, num);
     }
 
     bool from_num(std::string& str, float const& num) noexcept {
-        char buffer[64] = {};
-        auto const size = sprintf(buffer, "%.9g", num);
-        str = std::string(buffer, buffer + size);
-        return true;
+        char buffer[64];
+        auto const end = format_num(buffer, buffer + sizeof(buffer), num);
+        str = std::string(buffer, end);
+        return end != buffer;
+    }
+
+    char* from_num(char* first, char* last, float const& num) noexcept {
+        return format_num(first, last, num);
     }
 
     bool to_num(std::string_view str, double& num) noexcept {
-        auto copy = std::string(str.begin(), str.end());
-        return sscanf(copy.c_str(), "%lg", &num) == 1;
+        return parse_num(str, num);
     }
 
     bool from_num(std::string& str, double const& num) noexcept {
-        char buffer[64] = {};
-        auto const size = sprintf(buffer, "%.17lg", num);
-        str = std::string(buffer, buffer + size);
-        return true;
+        char buffer[64];
+        auto const end = format_num(buffer, buffer + sizeof(buffer), num);
+        str = std::string(buffer, end);
+        return end != buffer;
+    }
+
+    char* from_num(char* first, char* last, double const& num) noexcept {
+        return format_num(first, last, num);
     }
 }
 #endif
@@ -12,6 +12,11 @@ namespace ritobin {
     extern bool to_num(std::string_view str, double& num) noexcept;
 
     extern bool from_num(std::string& str, double const& num) noexcept;
+
+    // Shortest text that reads back to same value, returns end of written text or first if it didn't fit
+    extern char* from_num(char* first, char* last, float const& num) noexcept;
+
+    extern char* from_num(char* first, char* last, double const& num) noexcept;
 }
 #endif
 
@@ -36,6 +41,15 @@ namespace ritobin {
         return false;
     }
 
+    template<typename T>
+    inline char* from_num(char* first, char* last, T const& num, int base = 10) noexcept {
+        auto const [p, ec] = std::to_chars(first, last, num, base);
+        if (ec == std::errc{}) {
+            return p;
+        }
+        return first;
+    }
+
     extern bool to_num(std::string_view str, bool& num) noexcept;
 
     extern bool from_num(std::string& str, bool const& num) noexcept;
@@ -0,0 +1,166 @@
+#include "bin_scan.hpp"
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BIN_SCAN_X86
+#include <emmintrin.h>
+#endif
+
+namespace ritobin::scan_impl {
+    // Predicates either skip chars while they match or find first char that matches.
+    // Vector versions return 0xFF for every byte that matches.
+
+    struct Space {
+        static inline constexpr bool skip = true;
+
+        bool match(char c) const noexcept {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+#ifdef BIN_SCAN_X86
+        __m128i match(__m128i x) const noexcept {
+            return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+                                             _mm_cmpeq_epi8(x, _mm_set1_epi8('\t'))),
+                                _mm_cmpeq_epi8(x, _mm_set1_epi8('\r')));
+        }
+#endif
+    };
+
+    struct Word {
+        static inline constexpr bool skip = true;
+
+        bool match(char c) const noexcept {
+            return c == '_' || c == '+' || c == '-' || c == '.'
+                || (c >= 'A' && c <= 'Z')
+                || (c >= 'a' && c <= 'z')
+                || (c >= '0' && c <= '9');
+        }
+#ifdef BIN_SCAN_X86
+        // bytes above 0x7F are negative so signed range checks never match them
+        __m128i match(__m128i x) const noexcept {
+            auto const lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+            auto const alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                             _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+            auto const digit = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('0' - 1)),
+                                             _mm_cmplt_epi8(x, _mm_set1_epi8('9' + 1)));
+            auto const other = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('_')),
+                                                         _mm_cmpeq_epi8(x, _mm_set1_epi8('+'))),
+                                            _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('-')),
+                                                         _mm_cmpeq_epi8(x, _mm_set1_epi8('.'))));
+            return _mm_or_si128(_mm_or_si128(alpha, digit), other);
+        }
+#endif
+    };
+
+    struct Quote {
+        static inline constexpr bool skip = false;
+        char quote;
+
+        bool match(char c) const noexcept {
+            return c == quote || c == '\\';
+        }
+#ifdef BIN_SCAN_X86
+        __m128i match(__m128i x) const noexcept {
+            return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(quote)),
+                                _mm_cmpeq_epi8(x, _mm_set1_epi8('\\')));
+        }
+#endif
+    };
+
+    struct Escape {
+        static inline constexpr bool skip = false;
+
+        bool match(char c) const noexcept {
+            return c == '\\' || (uint8_t)c < 0x20;
+        }
+#ifdef BIN_SCAN_X86
+        // unsigned x <= 0x1F is same as min(x, 0x1F) == x
+        __m128i match(__m128i x) const noexcept {
+            return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\\')),
+                                _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(0x1F)), x));
+        }
+#endif
+    };
+
+    struct Nesting {
+        static inline constexpr bool skip = false;
+
+        bool match(char c) const noexcept {
+            return c == '{' || c == '}' || c == '"' || c == '\'' || c == '#';
+        }
+#ifdef BIN_SCAN_X86
+        __m128i match(__m128i x) const noexcept {
+            return _mm_or_si128(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('{')),
+                                                          _mm_cmpeq_epi8(x, _mm_set1_epi8('}'))),
+                                             _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')),
+                                                          _mm_cmpeq_epi8(x, _mm_set1_epi8('\'')))),
+                                _mm_cmpeq_epi8(x, _mm_set1_epi8('#')));
+        }
+#endif
+    };
+
+    struct Scalar {
+        static inline constexpr char name[] = "scalar";
+
+        template<typename P>
+        static char const* scan(char const* cur, char const* end, P const& pred) noexcept {
+            while (cur != end && pred.match(*cur) == P::skip) {
+                cur++;
+            }
+            return cur;
+        }
+    };
+
+#ifdef BIN_SCAN_X86
+    struct SSE2 {
+        static inline constexpr char name[] = "sse2";
+
+        template<typename P>
+        static char const* scan(char const* cur, char const* end, P const& pred) noexcept {
+            for (; end - cur >= 16; cur += 16) {
+                auto mask = (uint32_t)_mm_movemask_epi8(pred.match(_mm_loadu_si128((__m128i const*)cur)));
+                if constexpr (P::skip) {
+                    mask ^= 0xFFFFu;
+                }
+                if (mask) {
+                    return cur + std::countr_zero(mask);
+                }
+            }
+            return Scalar::scan(cur, end, pred);
+        }
+    };
+
+    // most runs in text are shorter than 16 bytes so wider vectors don't pay off
+    using Kernel = SSE2;
+#else
+    using Kernel = Scalar;
+#endif
+}
+
+namespace ritobin {
+    using namespace scan_impl;
+
+    char const* scan_space(char const* cur, char const* end) noexcept {
+        return Kernel::scan(cur, end, Space{});
+    }
+
+    char const* scan_word(char const* cur, char const* end) noexcept {
+        return Kernel::scan(cur, end, Word{});
+    }
+
+    char const* scan_quote(char const* cur, char const* end, char quote) noexcept {
+        return Kernel::scan(cur, end, Quote{quote});
+    }
+
+    char const* scan_escape(char const* cur, char const* end) noexcept {
+        return Kernel::scan(cur, end, Escape{});
+    }
+
+    char const* scan_nesting(char const* cur, char const* end) noexcept {
+        return Kernel::scan(cur, end, Nesting{});
+    }
+
+    char const* scan_kernels_name() noexcept {
+        return Kernel::name;
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef BIN_SCAN_HPP
+#define BIN_SCAN_HPP
+
+namespace ritobin {
+    // Text scanning kernels, vectorized with SSE2 where available with scalar fallback.
+    // Each returns pointer to first char in [cur, end) that stops the scan or end.
+
+    // Skips ' ', '\t' and '\r'
+    extern char const* scan_space(char const* cur, char const* end) noexcept;
+
+    // Skips letters, digits, '_', '+', '-' and '.'
+    extern char const* scan_word(char const* cur, char const* end) noexcept;
+
+    // Finds quote or backslash
+    extern char const* scan_quote(char const* cur, char const* end, char quote) noexcept;
+
+    // Finds backslash or control char below 0x20
+    extern char const* scan_escape(char const* cur, char const* end) noexcept;
+
+    // Finds brace, quote or comment start
+    extern char const* scan_nesting(char const* cur, char const* end) noexcept;
+
+    // Kernels in use: "sse2" or "scalar"
+    extern char const* scan_kernels_name() noexcept;
+}
+
+#endif // BIN_SCAN_HPP
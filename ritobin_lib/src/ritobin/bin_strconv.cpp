@@ -1,5 +1,6 @@
 #include "bin_strconv.hpp"
 #include "bin_numconv.hpp"
+#include "bin_scan.hpp"
 #include <optional>
 #include <bit>
 #include <span>
@@ -101,6 +102,10 @@ namespace ritobin::strconv_impl {
         StringIterator iter;
         void process(std::string& out) noexcept {
             while (iter.left()) {
+                // plain chars need no unescaping so copy whole run of them at once
+                auto const plain = scan_escape(iter.data(), iter.data() + iter.left());
+                out.append(iter.data(), plain);
+                iter.data_.remove_prefix((size_t)(plain - iter.data()));
                 if (!read_unicode_unescape(out)) {
                     break;
                 }
@@ -239,11 +244,17 @@ namespace ritobin {
     using namespace strconv_impl;
 
     char const* str_unquote_fetch_end(std::string_view data) noexcept {
-        auto iter = StringIterator { data };
-        for (auto quote = iter.pop(); iter.left() && iter.peek() != quote; iter.pop()) {
-            iter.match_str("\\");
+        if (data.empty()) {
+            return data.data();
         }
-        return iter.data();
+        auto const quote = data.front();
+        auto cur = data.data() + 1;
+        auto const end = data.data() + data.size();
+        // jump between backslashes, each one skips char after it
+        while ((cur = scan_quote(cur, end, quote)) != end && *cur != quote) {
+            cur = end - cur > 2 ? cur + 2 : end;
+        }
+        return cur;
     }
 
     char const* str_unquote(std::string_view data, std::string& out) noexcept {
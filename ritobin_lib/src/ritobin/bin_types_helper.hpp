@@ -2,6 +2,7 @@
 #define BIN_TYPE_HELPER_HPP
 
 #include "bin_types.hpp"
+#include <array>
 
 namespace ritobin {
     template<typename> struct ValueHelperImpl;
@@ -24,20 +25,68 @@ namespace ritobin {
             return std::visit([](auto&& value) { return value.type_name; }, value);
         }
 
+        static constexpr inline auto type_to_type_name_table = [] {
+            std::array<std::string_view, 256> table = {};
+            ((table[static_cast<uint8_t>(T::type)] = T::type_name), ...);
+            return table;
+        }();
+
         static constexpr std::string_view type_to_type_name(Type type) noexcept {
-            std::string_view type_name = {};
-            (void)((T::type == type ? (type_name = T::type_name, true) : false) || ...);
-            return type_name;
+            return type_to_type_name_table[static_cast<uint8_t>(type)];
         }
 
         static inline Value type_name_to_value(std::string_view type_name) noexcept {
-            Value value = None{};
-            (void)((type_name == T::type_name ? (value = T{}, true) : false) || ...);
-            return value;
+            Type type = {};
+            if (!try_type_name_to_type(type_name, type)) {
+                return None{};
+            }
+            return type_to_value(type);
         }
 
+        // Type names are looked up for every field in text and json so instead of comparing against each one
+        // they're placed by perfect hash of first char, last char and length, multipliers are found at compile time
+        struct TypeNameTable {
+            static constexpr size_t size = 64;
+            std::array<std::string_view, size> names = {};
+            std::array<Type, size> types = {};
+            uint32_t first_mul = {};
+            uint32_t last_mul = {};
+
+            constexpr size_t slot(std::string_view name) const noexcept {
+                return ((uint8_t)name.front() * first_mul + (uint8_t)name.back() * last_mul + name.size()) % size;
+            }
+        };
+
+        static constexpr inline auto type_name_table = [] {
+            for (uint32_t first_mul = 1; first_mul != TypeNameTable::size; first_mul++) {
+                for (uint32_t last_mul = 1; last_mul != TypeNameTable::size; last_mul++) {
+                    TypeNameTable table = { {}, {}, first_mul, last_mul };
+                    bool collision = false;
+                    auto place = [&](std::string_view name, Type type) {
+                        auto& slot_name = table.names[table.slot(name)];
+                        collision = collision || !slot_name.empty();
+                        slot_name = name;
+                        table.types[table.slot(name)] = type;
+                    };
+                    (place(T::type_name, T::type), ...);
+                    if (!collision) {
+                        return table;
+                    }
+                }
+            }
+            throw "No perfect hash for type names, grow the table!";
+        }();
+
         static constexpr bool try_type_name_to_type(std::string_view type_name, Type& type) noexcept {
-            return ((type_name == T::type_name ? (type = T::type, true) : false) || ...);
+            if (type_name.empty()) {
+                return false;
+            }
+            auto const slot = type_name_table.slot(type_name);
+            if (type_name_table.names[slot] != type_name) {
+                return false;
+            }
+            type = type_name_table.types[slot];
+            return true;
         }
 
         static constexpr Category type_to_category(Type type) noexcept {
@@ -111,6 +111,24 @@ namespace ritobin {
         }
     }
 
+    std::string const* BinUnhasher::find_fnv1a(uint32_t hash) const noexcept {
+        if (hash != 0) {
+            if (auto i = fnv1a.find(hash); i != fnv1a.end()) {
+                return &i->second;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string const* BinUnhasher::find_xxh64(uint64_t hash) const noexcept {
+        if (hash != 0) {
+            if (auto i = xxh64.find(hash); i != xxh64.end()) {
+                return &i->second;
+            }
+        }
+        return nullptr;
+    }
+
     void BinUnhasher::unhash_value(Value &value, int max_depth) const noexcept {
         if (max_depth > 0) {
             std::visit([this, max_depth] (auto& value) {
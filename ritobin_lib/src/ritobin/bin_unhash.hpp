@@ -13,6 +13,9 @@ namespace ritobin {
         void unhash_value(Value& bin, int max_depth) const noexcept;
         void unhash_hash(FNV1a& bin) const noexcept;
         void unhash_hash(XXH64& bin) const noexcept;
+        // Name unhash_hash would give to hash without copying it, nullptr when hash stays as is
+        std::string const* find_fnv1a(uint32_t hash) const noexcept;
+        std::string const* find_xxh64(uint64_t hash) const noexcept;
         bool load_fnv1a_CDTB(std::istream& istream) noexcept;
         bool load_fnv1a_CDTB(std::string const& filename) noexcept;
         bool load_xxh64_CDTB(std::istream& istream) noexcept;
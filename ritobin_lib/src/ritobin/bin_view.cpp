@@ -0,0 +1,189 @@
+#include "bin_view.hpp"
+#include "bin_io_binary_read.hpp"
+
+namespace ritobin::view_impl {
+    using io::impl_binary_skip::fixed_size;
+
+    // All reads here are unchecked, buffer has already been validated by BinView::open
+
+    template<typename T>
+    static inline T load(char const* data) noexcept {
+        T value = {};
+        memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    static inline Type load_type(char const* data, io::BinCompat const* compat) noexcept {
+        Type type = {};
+        (void)compat->raw_to_type(static_cast<uint8_t>(*data), type);
+        return type;
+    }
+
+    static char const* skip_value(Type type, char const* data, io::BinCompat const* compat) noexcept {
+        return io::impl_binary_skip::skip_value<false>(type, data, nullptr, compat);
+    }
+
+    static ViewRange<FieldView> fields_at(char const* data, io::BinCompat const* compat) noexcept {
+        ViewRange<FieldView> result = {};
+        result.count = load<uint16_t>(data);
+        result.data = data + sizeof(uint16_t);
+        result.compat = compat;
+        return result;
+    }
+}
+
+namespace ritobin {
+    using namespace view_impl;
+
+    char const* ValueView::end() const noexcept {
+        return skip_value(type, data, compat);
+    }
+
+    ClassView ValueView::as_class() const noexcept {
+        if (type != Type::POINTER && type != Type::EMBED) {
+            return {};
+        }
+        auto const name = load<uint32_t>(data);
+        if (name == 0 && type == Type::POINTER) {
+            return {};
+        }
+        return { name, fields_at(data + sizeof(uint32_t) * 2, compat) };
+    }
+
+    ListView ValueView::as_list() const noexcept {
+        ListView result = {};
+        if (type == Type::LIST || type == Type::LIST2) {
+            result.valueType = load_type(data, compat);
+            result.count = load<uint32_t>(data + 1 + sizeof(uint32_t));
+            result.data = data + 1 + sizeof(uint32_t) * 2;
+            result.compat = compat;
+        } else if (type == Type::OPTION) {
+            result.valueType = load_type(data, compat);
+            result.count = data[1] != 0 ? 1 : 0;
+            result.data = data + 2;
+            result.compat = compat;
+        }
+        return result;
+    }
+
+    MapView ValueView::as_map() const noexcept {
+        MapView result = {};
+        if (type == Type::MAP) {
+            result.keyType = load_type(data, compat);
+            result.valueType = load_type(data + 1, compat);
+            result.count = load<uint32_t>(data + 2 + sizeof(uint32_t));
+            result.data = data + 2 + sizeof(uint32_t) * 2;
+            result.compat = compat;
+        }
+        return result;
+    }
+
+    template<>
+    FieldView ViewRange<FieldView>::iterator::operator*() const noexcept {
+        auto const type = load_type(cur_ + sizeof(uint32_t), items_.compat);
+        return { load<uint32_t>(cur_), { type, cur_ + sizeof(uint32_t) + 1, items_.compat } };
+    }
+
+    template<>
+    ViewRange<FieldView>::iterator& ViewRange<FieldView>::iterator::operator++() noexcept {
+        cur_ = (**this).value.end();
+        --left_;
+        return *this;
+    }
+
+    template<>
+    ValueView ViewRange<ValueView>::iterator::operator*() const noexcept {
+        return { items_.valueType, cur_, items_.compat };
+    }
+
+    template<>
+    ViewRange<ValueView>::iterator& ViewRange<ValueView>::iterator::operator++() noexcept {
+        cur_ = skip_value(items_.valueType, cur_, items_.compat);
+        --left_;
+        return *this;
+    }
+
+    template<>
+    PairView ViewRange<PairView>::iterator::operator*() const noexcept {
+        auto const value = skip_value(items_.keyType, cur_, items_.compat);
+        return { { items_.keyType, cur_, items_.compat }, { items_.valueType, value, items_.compat } };
+    }
+
+    template<>
+    ViewRange<PairView>::iterator& ViewRange<PairView>::iterator::operator++() noexcept {
+        cur_ = (**this).value.end();
+        --left_;
+        return *this;
+    }
+
+    EntryView BinView::Entries::iterator::operator*() const noexcept {
+        auto const name = load<uint32_t>(names_ + sizeof(uint32_t) * index_);
+        auto const key = load<uint32_t>(cur_ + sizeof(uint32_t));
+        return { key, { name, fields_at(cur_ + sizeof(uint32_t) * 2, compat_) } };
+    }
+
+    BinView::Entries::iterator& BinView::Entries::iterator::operator++() noexcept {
+        cur_ += sizeof(uint32_t) + load<uint32_t>(cur_);
+        ++index_;
+        return *this;
+    }
+
+    PatchView BinView::Patches::iterator::operator*() const noexcept {
+        auto const key = load<uint32_t>(cur_);
+        auto const type = load_type(cur_ + sizeof(uint32_t) * 2, compat_);
+        auto const path_size = load<uint16_t>(cur_ + sizeof(uint32_t) * 2 + 1);
+        auto const path = cur_ + sizeof(uint32_t) * 2 + 1 + sizeof(uint16_t);
+        return { key, { path, path_size }, { type, path + path_size, compat_ } };
+    }
+
+    BinView::Patches::iterator& BinView::Patches::iterator::operator++() noexcept {
+        cur_ += sizeof(uint32_t) * 2 + load<uint32_t>(cur_ + sizeof(uint32_t));
+        --left_;
+        return *this;
+    }
+
+    std::string BinView::open(std::span<char const> data, io::BinCompat const* compat) noexcept {
+        using io::impl_binary_read::BinBinaryWalker;
+        using io::impl_binary_read::BinNullVisitor;
+        *this = {};
+        auto const begin = data.data();
+        auto const end = data.data() + data.size();
+        BinBinaryWalker<BinNullVisitor> walker = { {}, { begin, begin, end, compat }, {} };
+        if (!walker.process()) {
+            return walker.trace_error();
+        }
+
+        auto cur = begin;
+        type = { cur, 4 };
+        if (type == "PTCH") {
+            cur += 4 + sizeof(uint64_t);
+        }
+        cur += 4;
+        version = load<uint32_t>(cur);
+        cur += sizeof(uint32_t);
+        linked.valueType = Type::STRING;
+        linked.compat = compat;
+        if (version >= 2) {
+            linked.count = load<uint32_t>(cur);
+            linked.data = cur + sizeof(uint32_t);
+            cur = linked.data;
+            for (uint32_t i = 0; i != linked.count; i++) {
+                cur = skip_value(Type::STRING, cur, compat);
+            }
+        }
+        entries.count = load<uint32_t>(cur);
+        entries.names = cur + sizeof(uint32_t);
+        entries.data = entries.names + sizeof(uint32_t) * entries.count;
+        entries.compat = compat;
+        cur = entries.data;
+        for (uint32_t i = 0; i != entries.count; i++) {
+            cur += sizeof(uint32_t) + load<uint32_t>(cur);
+        }
+        patches.compat = compat;
+        if (cur != end) {
+            patches.count = load<uint32_t>(cur);
+            patches.data = cur + sizeof(uint32_t);
+        }
+        return {};
+    }
+}
@@ -0,0 +1,322 @@
+#ifndef BIN_VIEW_HPP
+#define BIN_VIEW_HPP
+
+#include <iterator>
+#include <optional>
+#include "bin_io.hpp"
+
+namespace ritobin {
+    template<typename T>
+    struct ViewValue {
+        using type = decltype(T::value);
+    };
+
+    template<>
+    struct ViewValue<String> {
+        using type = std::string_view;
+    };
+
+    template<>
+    struct ViewValue<Hash> {
+        using type = uint32_t;
+    };
+
+    template<>
+    struct ViewValue<Link> {
+        using type = uint32_t;
+    };
+
+    template<>
+    struct ViewValue<File> {
+        using type = uint64_t;
+    };
+
+    struct ClassView;
+    template<typename T> struct ViewRange;
+    struct FieldView;
+    struct PairView;
+    using ListView = ViewRange<struct ValueView>;
+    using MapView = ViewRange<PairView>;
+
+    // Read-only value pointing into validated .bin buffer
+    struct ValueView {
+        Type type = {};
+        char const* data = {};
+        io::BinCompat const* compat = {};
+
+        // Read primitive value, fails on type mismatch
+        template<typename T>
+        bool get(typename ViewValue<T>::type& value) const noexcept {
+            if (type != T::type) {
+                return false;
+            }
+            if constexpr (T::type == Type::STRING) {
+                uint16_t size = {};
+                memcpy(&size, data, sizeof(size));
+                value = { data + sizeof(size), size };
+            } else if constexpr (std::is_same_v<typename ViewValue<T>::type, bool>) {
+                value = *data != 0;
+            } else {
+                memcpy(&value, data, sizeof(value));
+            }
+            return true;
+        }
+
+        // Pointer or embed, empty for other types
+        ClassView as_class() const noexcept;
+        // List, list2 or option, empty for other types
+        ListView as_list() const noexcept;
+        // Map, empty for other types
+        MapView as_map() const noexcept;
+        // One past last byte of value
+        char const* end() const noexcept;
+    };
+
+    struct FieldView {
+        uint32_t key = {};
+        ValueView value = {};
+    };
+
+    struct PairView {
+        ValueView key = {};
+        ValueView value = {};
+    };
+
+    struct ViewItems {
+        char const* data = {};
+        uint32_t count = {};
+        Type keyType = {};
+        Type valueType = {};
+        io::BinCompat const* compat = {};
+    };
+
+    template<typename T>
+    struct ViewRange : ViewItems {
+        struct iterator {
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = T;
+            using pointer = T const*;
+            using reference = T;
+
+            ViewItems items_ = {};
+            char const* cur_ = {};
+            uint32_t left_ = {};
+
+            T operator*() const noexcept;
+
+            iterator& operator++() noexcept;
+
+            iterator operator++(int) noexcept {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            bool operator==(iterator const& other) const noexcept {
+                return left_ == other.left_;
+            }
+        };
+
+        iterator begin() const noexcept {
+            return { *this, data, count };
+        }
+
+        iterator end() const noexcept {
+            return { *this, nullptr, 0 };
+        }
+
+        size_t size() const noexcept {
+            return count;
+        }
+
+        bool empty() const noexcept {
+            return count == 0;
+        }
+    };
+
+    template<> FieldView ViewRange<FieldView>::iterator::operator*() const noexcept;
+    template<> ValueView ViewRange<ValueView>::iterator::operator*() const noexcept;
+    template<> PairView ViewRange<PairView>::iterator::operator*() const noexcept;
+    template<> ViewRange<FieldView>::iterator& ViewRange<FieldView>::iterator::operator++() noexcept;
+    template<> ViewRange<ValueView>::iterator& ViewRange<ValueView>::iterator::operator++() noexcept;
+    template<> ViewRange<PairView>::iterator& ViewRange<PairView>::iterator::operator++() noexcept;
+
+    struct ClassView {
+        uint32_t name = {};
+        ViewRange<FieldView> fields = {};
+
+        std::optional<ValueView> find_field(FNV1a const& key) const noexcept {
+            for (auto const& field: fields) {
+                if (field.key == key.hash()) {
+                    return field.value;
+                }
+            }
+            return std::nullopt;
+        }
+    };
+
+    struct EntryView {
+        uint32_t key = {};
+        ClassView value = {};
+    };
+
+    struct PatchView {
+        uint32_t key = {};
+        std::string_view path = {};
+        ValueView value = {};
+    };
+
+    // Read-only view over .bin buffer, buffer must outlive view
+    struct BinView {
+        struct Entries {
+            struct iterator {
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = EntryView;
+                using pointer = EntryView const*;
+                using reference = EntryView;
+
+                char const* names_ = {};
+                char const* cur_ = {};
+                uint32_t index_ = {};
+                io::BinCompat const* compat_ = {};
+
+                EntryView operator*() const noexcept;
+
+                iterator& operator++() noexcept;
+
+                iterator operator++(int) noexcept {
+                    auto copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                bool operator==(iterator const& other) const noexcept {
+                    return index_ == other.index_;
+                }
+            };
+
+            char const* names = {};
+            char const* data = {};
+            uint32_t count = {};
+            io::BinCompat const* compat = {};
+
+            iterator begin() const noexcept {
+                return { names, data, 0, compat };
+            }
+
+            iterator end() const noexcept {
+                return { names, nullptr, count, compat };
+            }
+
+            size_t size() const noexcept {
+                return count;
+            }
+
+            bool empty() const noexcept {
+                return count == 0;
+            }
+        };
+
+        struct Patches {
+            struct iterator {
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = PatchView;
+                using pointer = PatchView const*;
+                using reference = PatchView;
+
+                char const* cur_ = {};
+                uint32_t left_ = {};
+                io::BinCompat const* compat_ = {};
+
+                PatchView operator*() const noexcept;
+
+                iterator& operator++() noexcept;
+
+                iterator operator++(int) noexcept {
+                    auto copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                bool operator==(iterator const& other) const noexcept {
+                    return left_ == other.left_;
+                }
+            };
+
+            char const* data = {};
+            uint32_t count = {};
+            io::BinCompat const* compat = {};
+
+            iterator begin() const noexcept {
+                return { data, count, compat };
+            }
+
+            iterator end() const noexcept {
+                return { nullptr, 0, compat };
+            }
+
+            size_t size() const noexcept {
+                return count;
+            }
+
+            bool empty() const noexcept {
+                return count == 0;
+            }
+        };
+
+        // "PROP" or "PTCH"
+        std::string_view type = {};
+        uint32_t version = {};
+        ListView linked = {};
+        Entries entries = {};
+        Patches patches = {};
+
+        // Validate buffer once so views can be walked without any checks
+        std::string open(std::span<char const> data, io::BinCompat const* compat) noexcept;
+    };
+
+    // Events reported while walking .bin buffer, return false to stop the walk
+    // Values passed in are only valid for duration of the call unless buffer outlives them
+    struct BinVisitor {
+        virtual ~BinVisitor() noexcept = default;
+        // Type "PROP" or "PTCH" and version
+        virtual bool header(std::string_view, uint32_t) noexcept { return true; }
+        // Path of each linked file
+        virtual bool linked(std::string_view) noexcept { return true; }
+        // Number of entries
+        virtual bool begin_entries(uint32_t) noexcept { return true; }
+        virtual bool end_entries() noexcept { return true; }
+        // Key hash, class hash and number of fields that follow
+        virtual bool begin_entry(uint32_t, uint32_t, uint16_t) noexcept { return true; }
+        virtual bool end_entry() noexcept { return true; }
+        // Number of patches
+        virtual bool begin_patches(uint32_t) noexcept { return true; }
+        virtual bool end_patches() noexcept { return true; }
+        // Key hash, path and type of value that follows
+        virtual bool begin_patch(uint32_t, std::string_view, Type) noexcept { return true; }
+        virtual bool end_patch() noexcept { return true; }
+        // Name hash and type of value that follows
+        virtual bool field(uint32_t, Type) noexcept { return true; }
+        // Any primitive value, including list items and map keys
+        virtual bool value(ValueView const&) noexcept { return true; }
+        // Pointer or embed, class hash and number of fields that follow, null pointer has class hash 0
+        virtual bool begin_class(Type, uint32_t, uint16_t) noexcept { return true; }
+        virtual bool end_class() noexcept { return true; }
+        // List, list2 or option, item type and number of values that follow
+        virtual bool begin_list(Type, Type, uint32_t) noexcept { return true; }
+        virtual bool end_list() noexcept { return true; }
+        // Key type, value type and number of key and value pairs that follow
+        virtual bool begin_map(Type, Type, uint32_t) noexcept { return true; }
+        virtual bool end_map() noexcept { return true; }
+    };
+}
+
+namespace ritobin::io {
+    // Walk binary .bin in single pass without building Bin, reporting structure to visitor
+    extern std::string visit_binary(BinVisitor& visitor, std::span<char const> data, BinCompat const* compat) noexcept;
+}
+
+#endif // BIN_VIEW_HPP
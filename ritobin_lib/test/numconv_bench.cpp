@@ -0,0 +1,88 @@
+// Compares float conversions against sscanf/sprintf they replaced and times parsing of float heavy text.
+#include <ritobin/bin_io.hpp>
+#include <ritobin/bin_numconv.hpp>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using ritobin::from_num;
+using ritobin::to_num;
+
+template<typename F>
+static double time_ns(size_t count, F&& run) {
+    auto const start = std::chrono::steady_clock::now();
+    run();
+    auto const end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(count);
+}
+
+int main() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> small(-1000.0f, 1000.0f);
+    std::vector<float> nums(1 << 20);
+    for (auto& num : nums) {
+        num = small(rng);
+    }
+    std::vector<std::string> texts;
+    texts.reserve(nums.size());
+    for (auto num : nums) {
+        std::string text;
+        from_num(text, num);
+        texts.push_back(std::move(text));
+    }
+
+    float sink = 0.0f;
+    auto const parse_old = time_ns(texts.size(), [&] {
+        for (auto const& text : texts) {
+            float num = {};
+            auto copy = std::string(text.begin(), text.end());
+            sscanf(copy.c_str(), "%g", &num);
+            sink += num;
+        }
+    });
+    auto const parse_new = time_ns(texts.size(), [&] {
+        for (auto const& text : texts) {
+            float num = {};
+            to_num(text, num);
+            sink += num;
+        }
+    });
+    size_t length = 0;
+    auto const format_old = time_ns(nums.size(), [&] {
+        for (auto num : nums) {
+            char buffer[64];
+            length += static_cast<size_t>(sprintf(buffer, "%.9g", num));
+        }
+    });
+    auto const format_new = time_ns(nums.size(), [&] {
+        for (auto num : nums) {
+            char buffer[64];
+            length += static_cast<size_t>(from_num(buffer, buffer + sizeof(buffer), num) - buffer);
+        }
+    });
+
+    // single entry with list of vec3 and few matrices, same shape as mesh and animation data
+    std::string text = "#PROP_text\ntype: string = \"PROP\"\nversion: u32 = 3\nentries: map[hash,embed] = {\n"
+                       "  0x1 = Data {\n    points: list[vec3] = {\n";
+    for (size_t i = 0; i + 3 <= nums.size() / 4; i += 3) {
+        text += "      { " + texts[i] + ", " + texts[i + 1] + ", " + texts[i + 2] + " }\n";
+    }
+    text += "    }\n  }\n}\n";
+    ritobin::Bin bin;
+    auto error = std::string();
+    auto const parse_text = time_ns(1, [&] {
+        error = ritobin::io::read_text(bin, text);
+    });
+    if (!error.empty()) {
+        printf("Failed to parse text: %s\n", error.c_str());
+        return 1;
+    }
+
+    printf("parse float   sscanf %6.1f ns  to_num   %6.1f ns  %4.1fx\n", parse_old, parse_new, parse_old / parse_new);
+    printf("format float  sprintf %5.1f ns  from_num %6.1f ns  %4.1fx\n", format_old, format_new, format_old / format_new);
+    printf("read_text list[vec3] %.1f MB in %.1f ms\n", static_cast<double>(text.size()) / 1e6, parse_text / 1e6);
+    // keeps loops from being optimized out
+    return sink == 1.0f && length == 0 ? 2 : 0;
+}
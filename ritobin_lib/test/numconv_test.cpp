@@ -0,0 +1,65 @@
+// Exhaustive check that every float survives being written and read back, takes a while so it's opt-in.
+// Optional arguments limit it to range of bit patterns given in hex, e.g. "0 ffff".
+#include <ritobin/bin_numconv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using ritobin::from_num;
+using ritobin::to_num;
+
+static bool same(float a, float b) noexcept {
+    return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b) || (std::isnan(a) && std::isnan(b));
+}
+
+// Text writer emits shortest round-trip text while files written before it used "%.9g", both have to read back exactly
+static bool check(uint32_t bits) noexcept {
+    auto const num = std::bit_cast<float>(bits);
+    char buffer[64];
+    auto const end = from_num(buffer, buffer + sizeof(buffer), num);
+    float shortest = {};
+    if (end == buffer || !to_num({ buffer, static_cast<size_t>(end - buffer) }, shortest) || !same(num, shortest)) {
+        return false;
+    }
+    auto const size = snprintf(buffer, sizeof(buffer), "%.9g", num);
+    float old = {};
+    return size > 0 && to_num({ buffer, static_cast<size_t>(size) }, old) && same(num, old);
+}
+
+int main(int argc, char** argv) {
+    uint64_t first = 0;
+    uint64_t last = UINT64_C(1) << 32;
+    if (argc == 3) {
+        first = strtoull(argv[1], nullptr, 16);
+        last = strtoull(argv[2], nullptr, 16) + 1;
+    }
+    constexpr uint64_t chunk = 1 << 20;
+    std::atomic<uint64_t> next = first;
+    std::atomic<uint64_t> failed = 0;
+    auto work = [&] {
+        for (uint64_t start = next.fetch_add(chunk); start < last; start = next.fetch_add(chunk)) {
+            for (uint64_t bits = start; bits != std::min(start + chunk, last); bits++) {
+                if (!check(static_cast<uint32_t>(bits)) && failed++ < 16) {
+                    printf("Failed: 0x%08x\n", static_cast<uint32_t>(bits));
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < std::max(std::thread::hardware_concurrency(), 1u); i++) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    printf("Checked %llu floats, %llu failed\n", static_cast<unsigned long long>(last - first),
+           static_cast<unsigned long long>(failed.load()));
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}